@@ -0,0 +1,152 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#include <QtCore/QTemporaryDir>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+#include <QtTest/QtTest>
+#include <type_traits>
+
+template < typename T >
+constexpr typename std::underlying_type<T>::type underlying(const T value) Q_DECL_NOEXCEPT
+{
+    return static_cast<typename std::underlying_type<T>::type>(value);
+}
+
+#include "QIconSet.h"
+
+using qtex::QIconSet;
+
+namespace
+{
+    const int IconSize = 32;
+
+    enum class Column { A, B, C, D };
+    enum class Row { A, B, C, D };
+}
+
+/*!
+ * Measures loading and slicing icon sets of different grid sizes and the icon lookup rates
+ */
+class BenchQIconSet : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void construct_data()
+    {
+        QTest::addColumn<int>("grid");
+        QTest::addColumn<bool>("parallel");
+
+        QTest::newRow("4x4")            << 4    << false;
+        QTest::newRow("16x16")          << 16   << false;
+        QTest::newRow("64x64")          << 64   << false;
+        QTest::newRow("64x64 parallel") << 64   << true;
+    }
+
+    void construct()
+    {
+        QFETCH(int, grid);
+        QFETCH(bool, parallel);
+
+        const auto path    = sheet(grid);
+        const auto options = parallel ? QIconSet::ParallelSlicing : QIconSet::NoLoadOption;
+        QBENCHMARK
+        {
+            const QIconSet icons(path, QPoint(grid, grid), QPoint(IconSize, IconSize), nullptr, options);
+            Q_UNUSED(icons);
+        }
+    }
+
+    void getIconByIndex()
+    {
+        const QIconSet icons(sheet(16), QPoint(16, 16), QPoint(IconSize, IconSize));
+        const auto     count = 16 * 16;
+
+        qint64 valid = 0;
+        QBENCHMARK
+        {
+            for(auto index = 0; index < count; ++index)
+            {
+                valid += icons.getIcon(index).isNull() ? 0 : 1;
+            }
+        }
+        QVERIFY(valid > 0);
+    }
+
+    void getIconBy2D()
+    {
+        const QIconSet icons(sheet(16), QPoint(16, 16), QPoint(IconSize, IconSize));
+
+        qint64 valid = 0;
+        QBENCHMARK
+        {
+            for(auto row = 0; row < 16; ++row)
+            {
+                for(auto col = 0; col < 16; ++col)
+                {
+                    valid += icons.getIcon(col, row).isNull() ? 0 : 1;
+                }
+            }
+        }
+        QVERIFY(valid > 0);
+    }
+
+    void getIconByEnum()
+    {
+        const QIconSet icons(sheet(4), QPoint(4, 4), QPoint(IconSize, IconSize));
+
+        qint64 valid = 0;
+        QBENCHMARK
+        {
+            for(auto row = 0; row < 4; ++row)
+            {
+                for(auto col = 0; col < 4; ++col)
+                {
+                    valid += icons.getIcon(static_cast<Column>(col), static_cast<Row>(row)).isNull() ? 0 : 1;
+                }
+            }
+        }
+        QVERIFY(valid > 0);
+    }
+
+private:
+    QTemporaryDir m_dir;
+
+    //! Creates an icon set image of grid x grid distinctly colored icons
+    QString sheet(const int grid) const
+    {
+        const auto path = m_dir.filePath(QStringLiteral("sheet%1.png").arg(grid));
+        if(QFile::exists(path))
+        {
+            return path;
+        }
+
+        QImage image(grid * IconSize, grid * IconSize, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        for(auto index = 0; index < grid * grid; ++index)
+        {
+            const QRect rect((index % grid) * IconSize, (index / grid) * IconSize, IconSize, IconSize);
+            painter.fillRect(rect.adjusted(2, 2, -2, -2), QColor::fromHsv((index * 37) % 360, 200, 220));
+        }
+        painter.end();
+
+        image.save(path);
+        return path;
+    }
+};
+
+QTEST_MAIN(BenchQIconSet)
+#include "bench_qiconset.moc"
@@ -0,0 +1,301 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#include <QtCore/QSettings>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+template < typename T >
+constexpr typename std::underlying_type<T>::type underlying(const T value) Q_DECL_NOEXCEPT
+{
+    return static_cast<typename std::underlying_type<T>::type>(value);
+}
+
+#include "QSettingsContainer.h"
+
+namespace
+{
+    const int     KeyCount = 1000;
+    const QString Group    = QStringLiteral("Bench");
+
+    //! The native backend (e.g. the Windows registry) is only measured on request, as it writes to the user's store
+    bool nativeEnabled()
+    {
+        return qEnvironmentVariableIsSet("QTEX_BENCHMARK_NATIVE");
+    }
+}
+
+enum class Backend { Ini, Native };
+Q_DECLARE_METATYPE(Backend)
+
+/*!
+ * Measures the value()/setValue() throughput per key type and the read()/write() latency per backend
+ */
+class BenchQSettingsContainer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+
+        // Keeps file based native formats (e.g. on Linux) out of the user's configuration
+        QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, m_dir.path());
+
+        for(auto index = 0; index < KeyCount; ++index)
+        {
+            m_stringKeys.push_back(QStringLiteral("key%1").arg(index));
+            m_stdStringKeys.push_back(m_stringKeys.back().toStdString());
+        }
+    }
+
+    void cleanupTestCase()
+    {
+        if(nativeEnabled())
+        {
+            auto settings = open(Backend::Native);
+            settings->clear();
+        }
+    }
+
+    void valueInt()
+    {
+        EnumQSettingsContainer data(Group);
+        for(auto index = 0; index < KeyCount; ++index)
+        {
+            data.setValue(index, index);
+        }
+
+        qint64 sum = 0;
+        QBENCHMARK
+        {
+            for(auto index = 0; index < KeyCount; ++index)
+            {
+                sum += data.value(index, 0);
+            }
+        }
+        QVERIFY(sum > 0);
+    }
+
+    void valueQString()
+    {
+        StringQSettingsContainer data(Group);
+        for(auto index = 0; index < KeyCount; ++index)
+        {
+            data.setValue(m_stringKeys[index], index);
+        }
+
+        qint64 sum = 0;
+        QBENCHMARK
+        {
+            for(const auto& key : m_stringKeys)
+            {
+                sum += data.value(key, 0);
+            }
+        }
+        QVERIFY(sum > 0);
+    }
+
+    void valueStdString()
+    {
+        StdStringQSettingsContainer data(Group);
+        for(auto index = 0; index < KeyCount; ++index)
+        {
+            data.setValue(m_stdStringKeys[index], index);
+        }
+
+        qint64 sum = 0;
+        QBENCHMARK
+        {
+            for(const auto& key : m_stdStringKeys)
+            {
+                sum += data.value(key.c_str(), 0);
+            }
+        }
+        QVERIFY(sum > 0);
+    }
+
+    void setValueInt()
+    {
+        EnumQSettingsContainer data(Group);
+        auto round = 0;
+        QBENCHMARK
+        {
+            ++round;
+            for(auto index = 0; index < KeyCount; ++index)
+            {
+                data.setValue(index, round);
+            }
+        }
+    }
+
+    void setValuesDense()
+    {
+        std::vector<int> values(KeyCount);
+        auto round = 0;
+        QBENCHMARK
+        {
+            ++round;
+            std::fill(values.begin(), values.end(), round);
+
+            DenseEnumQSettingsContainer data(Group);
+            data.reserve(KeyCount);
+            data.setValues(0, values.begin(), values.end());
+        }
+    }
+
+    void setValueQString()
+    {
+        StringQSettingsContainer data(Group);
+        auto round = 0;
+        QBENCHMARK
+        {
+            ++round;
+            for(const auto& key : m_stringKeys)
+            {
+                data.setValue(key, round);
+            }
+        }
+    }
+
+    void setValueStdString()
+    {
+        StdStringQSettingsContainer data(Group);
+        auto round = 0;
+        QBENCHMARK
+        {
+            ++round;
+            for(const auto& key : m_stdStringKeys)
+            {
+                data.setValue(key, round);
+            }
+        }
+    }
+
+    void read_data()
+    {
+        addBackendRows();
+    }
+
+    void read()
+    {
+        QFETCH(Backend, backend);
+        QFETCH(int, count);
+
+        fill(backend, count);
+        QBENCHMARK
+        {
+            // A new instance each time, so the backend is actually parsed
+            auto settings = open(backend);
+            EnumQSettingsContainer data(Group);
+            data.read(*settings);
+        }
+    }
+
+    void write_data()
+    {
+        addBackendRows();
+    }
+
+    void write()
+    {
+        QFETCH(Backend, backend);
+        QFETCH(int, count);
+
+        EnumQSettingsContainer data(Group);
+        for(auto index = 0; index < count; ++index)
+        {
+            data.setValue(index, index);
+        }
+
+        auto settings = open(backend);
+        QBENCHMARK
+        {
+            data.writeAll(*settings);
+            settings->sync();
+        }
+    }
+
+    void writeSingleChange_data()
+    {
+        addBackendRows();
+    }
+
+    void writeSingleChange()
+    {
+        QFETCH(Backend, backend);
+        QFETCH(int, count);
+
+        fill(backend, count);
+        auto settings = open(backend);
+
+        EnumQSettingsContainer data(Group);
+        data.read(*settings);
+
+        auto round = 0;
+        QBENCHMARK
+        {
+            data.setValue(0, ++round);
+            data.write(*settings);
+            settings->sync();
+        }
+    }
+
+private:
+    QTemporaryDir               m_dir;
+    std::vector<QString>        m_stringKeys;
+    std::vector<std::string>    m_stdStringKeys;
+
+    void addBackendRows()
+    {
+        QTest::addColumn<Backend>("backend");
+        QTest::addColumn<int>("count");
+
+        for(const auto count : {10, 1000, 100000})
+        {
+            QTest::newRow(qPrintable(QStringLiteral("ini/%1").arg(count)))    << Backend::Ini << count;
+            if(nativeEnabled())
+            {
+                QTest::newRow(qPrintable(QStringLiteral("native/%1").arg(count))) << Backend::Native << count;
+            }
+        }
+    }
+
+    std::unique_ptr<QSettings> open(const Backend backend) const
+    {
+        if(backend == Backend::Ini)
+        {
+            return std::unique_ptr<QSettings>(new QSettings(m_dir.filePath(QStringLiteral("bench.ini")), QSettings::IniFormat));
+        }
+        return std::unique_ptr<QSettings>(new QSettings(QSettings::NativeFormat, QSettings::UserScope,
+                                                        QStringLiteral("qtex"), QStringLiteral("qtex-benchmark")));
+    }
+
+    //! Replaces the group with count keys
+    void fill(const Backend backend, const int count) const
+    {
+        auto settings = open(backend);
+        settings->remove(Group);
+        settings->beginGroup(Group);
+        for(auto index = 0; index < count; ++index)
+        {
+            settings->setValue(QString::number(index), index);
+        }
+        settings->endGroup();
+        settings->sync();
+    }
+};
+
+QTEST_MAIN(BenchQSettingsContainer)
+#include "bench_qsettingscontainer.moc"
@@ -0,0 +1,170 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QCONCURRENTSETTINGSCONTAINER_H
+#define QCONCURRENTSETTINGSCONTAINER_H
+
+#include <QtCore/QMutex>
+#include <QtCore/QSettings>
+#include <memory>
+
+#include "QSettingsContainer.h"
+
+namespace qtex
+{
+    /*!
+     * \class QConcurrentSettingsContainer
+     * \brief QSettingsContainer which is read from any thread while being modified by another one
+     *
+     * The data is published as immutable, reference counted snapshots (read-copy-update). Readers grab the
+     * current snapshot and read from it without any further synchronization, so a reader never waits for a
+     * writer to finish its changes. A writer copies the current snapshot, applies its changes to the copy
+     * and publishes the copy by swapping the snapshot pointer. Readers still holding the previous snapshot
+     * keep a consistent view of it until they release it.
+     *
+     * Since every modification copies the data, batch changes with update() instead of calling setValue()
+     * for each key.
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * QConcurrentSettingsContainer<int> preferences("Render");
+     *
+     * // GUI thread
+     * preferences.update([&](EnumQSettingsContainer& data)
+     * {
+     *     data.setValue(Samples, samplesBox->value());
+     *     data.setValue(Denoise, denoiseBox->isChecked());
+     * });
+     *
+     * // Render thread
+     * const auto samples = preferences.value(Samples, 16);
+     * //or, for a consistent view of several values
+     * const auto snapshot = preferences.snapshot();
+     * const auto denoise  = snapshot->value(Denoise, false);
+     * \endcode
+     *
+     * The snapshot pointer is swapped with the std::atomic_load/std::atomic_store overloads for shared_ptr.
+     * Note that libstdc++ and MSVC implement those with a small pool of spin locks guarding just the pointer
+     * copy rather than being truly lock-free, readers still never block on a writer's copy or changes.
+     * Writers are serialized among each other.
+     *
+     * \tparam T_Key See QSettingsContainer
+     * \tparam T_Storage See QSettingsContainer
+     */
+    template < typename T_Key, typename T_Storage = QSettingsMapStorage<T_Key> >
+    class QConcurrentSettingsContainer
+    {
+    public:
+        using Container = QSettingsContainer<T_Key, T_Storage>;
+        using Snapshot  = std::shared_ptr<const Container>;
+
+        explicit QConcurrentSettingsContainer(const QString& group)
+            : m_snapshot(std::make_shared<const Container>(group))
+        {
+        }
+
+        //! Retrieves the current data, may be called from any thread
+        Snapshot snapshot() const
+        {
+            return std::atomic_load(&m_snapshot);
+        }
+
+        //! Retrieves a value of the current snapshot, may be called from any thread, see QSettingsContainer::value()
+        template < typename T, typename T_Id >
+        T value(const T_Id& index, const T& defaultValue = T(0)) const
+        {
+            return snapshot()->value(index, defaultValue);
+        }
+
+        //! Checks the current snapshot for a key, may be called from any thread
+        template < typename T_Id >
+        bool contains(const T_Id& key) const
+        {
+            return snapshot()->contains(key);
+        }
+
+        /*!
+         * Applies changes to a copy of the data and publishes it as the new snapshot
+         * \param fn Called with the copy as a Container&, do not let the reference escape
+         */
+        template < typename Fn >
+        void update(Fn&& fn)
+        {
+            QMutexLocker lock(&m_writeMutex);
+
+            auto next = std::make_shared<Container>(*std::atomic_load(&m_snapshot));
+            fn(*next);
+            std::atomic_store(&m_snapshot, Snapshot(std::move(next)));
+        }
+
+        //! Sets a single value, returns true if the value changed. Use update() for multiple values.
+        template < typename KeyType >
+        bool setValue(const KeyType& key, const QVariant& value)
+        {
+            auto changed = false;
+            update([&](Container& data) { changed = data.setValue(key, value); });
+            return changed;
+        }
+
+        //! reads procedural settings of the given settings group and publishes them
+        void read(QSettings& settings)
+        {
+            update([&settings](Container& data) { data.read(settings); });
+        }
+
+        //! writes the dirty procedural settings to the given settings group, see QSettingsContainer::write()
+        void write(QSettings& settings)
+        {
+            if(!snapshot()->isDirty())
+            {
+                return;
+            }
+            update([&settings](Container& data) { data.write(settings); });
+        }
+
+        //! Takes the dirty values and clears the dirty flags, see QSettingsContainer::takeChanges()
+        QSettingsChanges takeChanges()
+        {
+            QSettingsChanges changes;
+            update([&changes](Container& data) { changes = data.takeChanges(); });
+            return changes;
+        }
+
+        //! Retrieves the dirty values of the current snapshot, see QSettingsContainer::getChanges()
+        QSettingsChanges getChanges() const
+        {
+            return snapshot()->getChanges();
+        }
+
+        /*!
+         * marks all values as written, e.g. after they have been persisted in some other way
+         * \remark Values changed by other threads since getChanges() are marked as well, use takeChanges() if
+         * writers run concurrently
+         */
+        void clearDirty()
+        {
+            if(!snapshot()->isDirty())
+            {
+                return;
+            }
+            update([](Container& data) { data.clearDirty(); });
+        }
+
+        QString getGroupName() const
+        {
+            return snapshot()->getGroupName();
+        }
+
+    private:
+        Snapshot    m_snapshot;     //<! The current data, only accessed through std::atomic_load/std::atomic_store
+        QMutex      m_writeMutex;   //<! Serializes the writers
+    };
+}    // namespace qtex
+
+
+#endif    // QCONCURRENTSETTINGSCONTAINER_H
@@ -0,0 +1,274 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QICONATLAS_H
+#define QICONATLAS_H
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QObject>
+#include <QtCore/QSaveFile>
+#include <QtCore/QVector>
+#include <QtGui/QIcon>
+#include <type_traits>
+#include <vector>
+
+#include "QIconSetEngine.h"
+
+namespace qtex
+{
+    /*!
+     * \class QIconAtlas
+     * \brief Handles icons of arbitrary sizes packed into a single image
+     *
+     * Unlike QIconSet which requires a uniform grid of equally sized icons, an atlas is described by a
+     * layout descriptor listing a named rectangle for each icon. So icons of mixed sizes (e.g. 16px, 24px
+     * and 48px) can be packed tightly into one image without any padding.
+     *
+     * The icons are accessible by their name or by their (zero-based) position in the layout descriptor,
+     * which is also what the enum overloads use. All icons paint straight from the atlas image
+     * (see QIconSetEngine), so the atlas is decoded once and no pixel data is ever duplicated.
+     *
+     * The layout descriptor is either a JSON file
+     * \code {.json}
+     * { "icons": [ { "name": "open", "rect": [0, 0, 16, 16] },
+     *              { "name": "save", "rect": [16, 0, 24, 24] } ] }
+     * \endcode
+     * or its compact binary form as written by saveLayout().
+     */
+    class QIconAtlas : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /*!
+         * Constructs an atlas out of a resource image file and its layout descriptor
+         * \param path The resource path of the atlas image, e.g. ":/ui/atlas.png"
+         * \param layoutPath The resource path of the layout descriptor, e.g. ":/ui/atlas.json"
+         * \param parent The parent QObject
+         */
+        QIconAtlas(const QString& path, const QString& layoutPath, QObject* parent = nullptr)
+            : QObject   (parent)
+            , m_atlas   (path)
+        {
+            Q_ASSERT(!m_atlas.isNull());
+
+            const auto loaded = readLayout(layoutPath);
+            Q_ASSERT(loaded);
+            Q_UNUSED(loaded);
+
+            m_icons.resize(m_rects.size());
+        }
+
+        /*!
+         * Get an icon at the specified position in the layout descriptor
+         * \param index The zero-based position of the icon in the layout descriptor
+         * \returns The icon as a QIcon
+         */
+        const QIcon& getIcon(const int index) const
+        {
+            Q_ASSERT(isValid(index));
+            if(!isValid(index))
+            {
+                return m_invalidIcon;
+            }
+
+            auto& icon = m_icons[index];
+            if(icon.isNull())
+            {
+                icon = QIcon(new QIconSetEngine(m_atlas, m_rects[index]));
+            }
+            return icon;
+        }
+
+        /*!
+         * Get an icon at the specified position in the layout descriptor. While the position is given by an enum!
+         * \param index The zero-based position of the icon in the layout descriptor
+         * \returns The icon as a QIcon
+         */
+        template < typename IndexType, typename = typename std::enable_if<std::is_enum<IndexType>::value>::type >
+        const QIcon& getIcon(const IndexType index) const
+        {
+            return getIcon(static_cast<int>(underlying(index)));
+        }
+
+        /*!
+         * Get an icon by its name
+         * \param name The name of the icon as given in the layout descriptor
+         * \returns The icon as a QIcon
+         */
+        const QIcon& getIcon(const QString& name) const
+        {
+            return getIcon(indexOf(name));
+        }
+
+        /*!
+         * Retrieves the position of an icon in the layout descriptor
+         * \param name The name of the icon
+         * \returns The zero-based position or -1 if there is no such icon
+         */
+        int indexOf(const QString& name) const
+        {
+            return m_names.value(name, -1);
+        }
+
+        /*!
+         * Check if there is an icon at the specified position
+         * \param index The zero-based position of the icon in the layout descriptor
+         * \returns True if an icon exists at the given position
+         */
+        bool isValid(const int index) const Q_DECL_NOEXCEPT
+        {
+            return index >= 0 && index < static_cast<int>(m_rects.size());
+        }
+
+        /*!
+         * Retrieves the area an icon occupies within the atlas image
+         * \param index The zero-based position of the icon in the layout descriptor
+         * \returns The icon area in pixels, a null rect if there is no such icon
+         */
+        QRect getIconRect(const int index) const
+        {
+            return isValid(index) ? m_rects[index] : QRect();
+        }
+
+        //! Retrieves the amount of icons in the atlas
+        int getIconCount() const Q_DECL_NOEXCEPT
+        {
+            return static_cast<int>(m_rects.size());
+        }
+
+        /*!
+         * Writes the layout descriptor in its compact binary form
+         * \param layoutPath The path of the layout descriptor file to write
+         * \returns True on success
+         */
+        bool saveLayout(const QString& layoutPath) const
+        {
+            QSaveFile file(layoutPath);
+            if(!file.open(QIODevice::WriteOnly))
+            {
+                return false;
+            }
+
+            QDataStream stream(&file);
+            stream.setVersion(QDataStream::Qt_5_6);
+            stream << Magic << Version << static_cast<qint32>(m_rects.size());
+
+            QVector<QString> names(static_cast<int>(m_rects.size()));
+            for(auto it = m_names.cbegin(); it != m_names.cend(); ++it)
+            {
+                names[it.value()] = it.key();
+            }
+            for(auto index = 0; index < static_cast<int>(m_rects.size()); ++index)
+            {
+                const auto& rect = m_rects[index];
+                stream << names[index] << static_cast<qint32>(rect.x()) << static_cast<qint32>(rect.y())
+                       << static_cast<qint32>(rect.width()) << static_cast<qint32>(rect.height());
+            }
+            return stream.status() == QDataStream::Ok && file.commit();
+        }
+
+    private:
+        static const quint32 Magic   = 0x4c414951;  //<! "QIAL" in little endian
+        static const quint32 Version = 1;
+
+        QPixmap                     m_atlas;        //<! The atlas image
+        std::vector<QRect>          m_rects;        //<! The icon areas in layout descriptor order
+        QHash<QString, int>         m_names;        //<! Maps an icon name to its position
+        mutable std::vector<QIcon>  m_icons;        //<! The icons, null until requested
+        QIcon                       m_invalidIcon;  //<! Can be returned in case of an icon failure
+
+        //! Reads the layout descriptor, either in its binary or JSON form
+        bool readLayout(const QString& layoutPath)
+        {
+            QFile file(layoutPath);
+            if(!file.open(QIODevice::ReadOnly))
+            {
+                return false;
+            }
+
+            const auto data = file.readAll();
+            if(readBinaryLayout(data))
+            {
+                return true;
+            }
+
+            m_rects.clear();
+            m_names.clear();
+            return readJsonLayout(data);
+        }
+
+        bool readBinaryLayout(const QByteArray& data)
+        {
+            QDataStream stream(data);
+            stream.setVersion(QDataStream::Qt_5_6);
+
+            quint32 magic   = 0;
+            quint32 version = 0;
+            qint32  count   = 0;
+            stream >> magic >> version >> count;
+            if(magic != Magic || version != Version || count < 0)
+            {
+                return false;
+            }
+
+            m_rects.reserve(count);
+            m_names.reserve(count);
+            for(auto index = 0; index < count; ++index)
+            {
+                QString name;
+                qint32  x = 0, y = 0, w = 0, h = 0;
+                stream >> name >> x >> y >> w >> h;
+                addIcon(name, QRect(x, y, w, h));
+            }
+            return stream.status() == QDataStream::Ok;
+        }
+
+        bool readJsonLayout(const QByteArray& data)
+        {
+            const auto document = QJsonDocument::fromJson(data);
+            if(!document.isObject())
+            {
+                return false;
+            }
+
+            const auto icons = document.object().value(QStringLiteral("icons")).toArray();
+            m_rects.reserve(icons.size());
+            m_names.reserve(icons.size());
+            for(const auto& value : icons)
+            {
+                const auto icon = value.toObject();
+                const auto rect = icon.value(QStringLiteral("rect")).toArray();
+                if(rect.size() != 4)
+                {
+                    return false;
+                }
+                addIcon(icon.value(QStringLiteral("name")).toString(),
+                        QRect(rect.at(0).toInt(), rect.at(1).toInt(), rect.at(2).toInt(), rect.at(3).toInt()));
+            }
+            return true;
+        }
+
+        void addIcon(const QString& name, const QRect& rect)
+        {
+            if(!name.isEmpty())
+            {
+                m_names.insert(name, static_cast<int>(m_rects.size()));
+            }
+            m_rects.push_back(rect);
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QICONATLAS_H
@@ -0,0 +1,188 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QICONEFFECT_H
+#define QICONEFFECT_H
+
+#include <QtGui/QColor>
+#include <QtGui/QImage>
+#include <QtGui/QPixmap>
+#include <array>
+
+namespace qtex
+{
+    /*!
+     * \class QIconEffect
+     * \brief Describes how an icon state variant (e.g. the disabled look) is derived from the normal icon
+     *
+     * The effect is applied in this order: conversion to grayscale, tinting towards a color and fading by
+     * an opacity. All transformations work on whole premultiplied ARGB32 scanlines in branch-free loops,
+     * so the compiler is able to vectorize them.
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * iconset.setModeEffect(QIcon::Disabled, QIconEffect(true, QColor(), 0.5));
+     * iconset.setModeEffect(QIcon::Selected, QIconEffect(false, palette.highlightedText().color()));
+     * \endcode
+     */
+    class QIconEffect
+    {
+    public:
+        /*!
+         * Constructs an effect
+         * \param grayscale If true the icon is converted to grayscale
+         * \param tint The color to tint the icon with, its alpha is the tint strength. Invalid for no tint.
+         * \param opacity The opacity to fade the icon to
+         */
+        explicit QIconEffect(const bool grayscale = false, const QColor& tint = QColor(), const qreal opacity = 1.0)
+            : m_grayscale   (grayscale)
+            , m_tint        (tint)
+            , m_opacity     (opacity)
+        {
+        }
+
+        //! The effect generating disabled icons if none is set, grayscale at half opacity
+        static const QIconEffect& disabled()
+        {
+            static const QIconEffect effect(true, QColor(), 0.5);
+            return effect;
+        }
+
+        //! True if the effect doesn't change the icon at all
+        bool isNull() const
+        {
+            return !m_grayscale && (!m_tint.isValid() || m_tint.alpha() == 0) && m_opacity >= 1.0;
+        }
+
+        //! True if the icon is converted to grayscale
+        bool isGrayscale() const Q_DECL_NOEXCEPT
+        {
+            return m_grayscale;
+        }
+
+        //! The tint color, invalid if not tinted
+        const QColor& getTint() const Q_DECL_NOEXCEPT
+        {
+            return m_tint;
+        }
+
+        //! The opacity the icon is faded to
+        qreal getOpacity() const Q_DECL_NOEXCEPT
+        {
+            return m_opacity;
+        }
+
+        /*!
+         * Applies the effect to an image
+         * \param source The image
+         * \returns The transformed image in premultiplied ARGB32 format
+         */
+        QImage apply(const QImage& source) const
+        {
+            auto image = source.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            if(isNull())
+            {
+                return image;
+            }
+
+            const auto tinted  = m_tint.isValid() && m_tint.alpha() > 0;
+            const auto opacity = static_cast<quint32>(qRound(qBound(0.0, m_opacity, 1.0) * 256));
+            for(auto y = 0; y < image.height(); ++y)
+            {
+                auto* line = reinterpret_cast<quint32*>(image.scanLine(y));
+                if(m_grayscale)
+                {
+                    grayscaleLine(line, image.width());
+                }
+                if(tinted)
+                {
+                    tintLine(line, image.width(), m_tint);
+                }
+                if(opacity < 256)
+                {
+                    fadeLine(line, image.width(), opacity);
+                }
+            }
+            return image;
+        }
+
+        /*!
+         * Applies the effect to a pixmap
+         * \param source The pixmap
+         * \returns The transformed pixmap with the device pixel ratio of the source
+         */
+        QPixmap apply(const QPixmap& source) const
+        {
+            auto pmap = QPixmap::fromImage(apply(source.toImage()));
+            pmap.setDevicePixelRatio(source.devicePixelRatio());
+            return pmap;
+        }
+
+    private:
+        bool    m_grayscale;    //<! Convert to grayscale
+        QColor  m_tint;         //<! Tint color, the alpha is the tint strength
+        qreal   m_opacity;      //<! Fade to opacity
+
+        //! Converts a premultiplied scanline to grayscale using the qGray() weights
+        static void grayscaleLine(quint32* line, const int width) Q_DECL_NOEXCEPT
+        {
+            for(auto x = 0; x < width; ++x)
+            {
+                const auto p    = line[x];
+                const auto gray = (((p >> 16) & 0xff) * 11 + ((p >> 8) & 0xff) * 16 + (p & 0xff) * 5) >> 5;
+
+                line[x] = (p & 0xff000000) | (gray << 16) | (gray << 8) | gray;
+            }
+        }
+
+        //! Blends a premultiplied scanline towards the tint color while keeping the alpha
+        static void tintLine(quint32* line, const int width, const QColor& tint) Q_DECL_NOEXCEPT
+        {
+            const auto tr       = static_cast<qint32>(tint.red());
+            const auto tg       = static_cast<qint32>(tint.green());
+            const auto tb       = static_cast<qint32>(tint.blue());
+            const auto strength = static_cast<qint32>(tint.alpha() + (tint.alpha() >> 7));    // 0..256
+
+            for(auto x = 0; x < width; ++x)
+            {
+                const auto p = line[x];
+                const auto a = static_cast<qint32>(p >> 24);
+                const auto r = static_cast<qint32>((p >> 16) & 0xff);
+                const auto g = static_cast<qint32>((p >> 8) & 0xff);
+                const auto b = static_cast<qint32>(p & 0xff);
+
+                // The tint color premultiplied by the pixel alpha
+                const auto nr = r + ((((tr * a) / 255) - r) * strength >> 8);
+                const auto ng = g + ((((tg * a) / 255) - g) * strength >> 8);
+                const auto nb = b + ((((tb * a) / 255) - b) * strength >> 8);
+
+                line[x] = (p & 0xff000000) | (static_cast<quint32>(nr) << 16) | (static_cast<quint32>(ng) << 8) |
+                          static_cast<quint32>(nb);
+            }
+        }
+
+        //! Multiplies all channels of a premultiplied scanline by an opacity given in 0..256
+        static void fadeLine(quint32* line, const int width, const quint32 opacity) Q_DECL_NOEXCEPT
+        {
+            for(auto x = 0; x < width; ++x)
+            {
+                const auto p  = line[x];
+                const auto rb = (((p & 0x00ff00ff) * opacity) >> 8) & 0x00ff00ff;
+                const auto ag = (((p >> 8) & 0x00ff00ff) * opacity) & 0xff00ff00;
+
+                line[x] = ag | rb;
+            }
+        }
+    };
+
+    //! The effects of an icon set indexed by QIcon::Mode
+    using QIconEffects = std::array<QIconEffect, 4>;
+}    // namespace qtex
+
+
+#endif    // QICONEFFECT_H
@@ -9,10 +9,23 @@
 #ifndef QICONSET_H
 #define QICONSET_H
 
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QHash>
 #include <QtCore/QObject>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
 #include <QtGui/QIcon>
+#include <QtGui/QImage>
 #include <type_traits>
 
+#include "QIconSetCacheFile.h"
+#include "QIconSetEngine.h"
+#include "QMetrics.h"
+
 namespace qtex
 {
     /*!
@@ -32,27 +45,72 @@ namespace qtex
      * him check and review consistency/difference of style, color palette etc. so this is a straightforward
      * way to handle application icons dynamically.
      *
-     * Todo: 
-     * storage optimization. Currently there is no way to avoid "empty" icon areas which take up unnecessary memory.
+     * Storage optimization: with the SkipEmptyTiles option fully transparent ("empty") icon areas are detected
+     * at load time and never allocated. The populated icons are kept in a compact array which is addressed
+     * through an index map, so holes in the icon set neither take up memory nor report as valid icons.
+     * With the TrimTransparentBorders option additionally the opaque bounding box of each icon is computed
+     * at load time. Icons then only keep the pixels within their box and paint them at their offset within
+     * the cell. This doesn't apply to SharedSheet icons, which own no pixels, nor to icons with high
+     * resolution variants. Once all icons have been extracted the icon set image itself is released, unless
+     * it is still needed by LazyExtraction, setWatching() or setResidencyTimeout(). Re-extracting icons later
+     * on, e.g. after setModeEffect(), decodes the image again.
+     *
+     * Large icon set images can be decoded in the background via loadAsync(). Until the loaded() signal
+     * has been emitted the icon set behaves as if empty and returns the placeholder icon.
+     *
+     * Icon set images with thousands of icons can be sliced on all cores via the ParallelSlicing option.
+     * The image is decoded once, then each row of icons is sliced into its pre-sized slots by a separate
+     * task. Only the final conversion into pixmaps is left to the GUI thread.
+     *
+     * To avoid decoding the icon set image at all on subsequent runs, a fully sliced icon set can be stored
+     * in a binary cache file via saveCache() and loaded again via loadCached() (see QIconSetCacheFile).
+     *
+     * For high-DPI screens additional icon set images at higher device pixel ratios can be registered via
+     * addResolution(). They are only decoded once a screen with the matching device pixel ratio asks for them.
+     *
+     * Long-running applications keeping many icon sets alive can cap their memory via setResidencyTimeout().
+     * Icons not requested for the given time are dropped and re-extracted on their next request, and once
+     * the whole icon set is idle its image is compressed until an icon is requested again.
+     *
+     * Icon set images edited on disk while the application runs are picked up via setWatching(). Only the
+     * icons whose pixels changed are re-extracted, in place, and reported by iconsChanged().
+     *
+     * The disabled, active and selected looks of the icons can be generated via setModeEffect() (see QIconEffect).
+     * Each look is generated at most once per icon, so repainting e.g. disabled icons is as cheap as normal ones.
      */
     class QIconSet : public QObject
     {
         Q_OBJECT
 
     public:
+        //! Options controlling how the icons are extracted out of the icon set image
+        enum LoadOption
+        {
+            NoLoadOption    = 0x0,
+            LazyExtraction  = 0x1,  //!< Icons are extracted on their first request instead of at construction
+            SharedSheet     = 0x2,  //!< Icons paint straight from the icon set image instead of owning a copy (see QIconSetEngine)
+            SkipEmptyTiles  = 0x4,  //!< Fully transparent icon areas are not stored and report as invalid
+            ParallelSlicing = 0x8,  //!< The rows of icons are sliced (and checked for emptiness) concurrently
+            TrimTransparentBorders = 0x10   //!< Icons only keep the pixels of their opaque bounding box (see QTrimmedIconEngine)
+        };
+        Q_DECLARE_FLAGS(LoadOptions, LoadOption)
+
         /*!
          * Constructs an icon set out of a resource image file path
          * \param path The resource path of the icon set, e.g. ":/buttons/iconset.png"
          * \param colRow The (maximum) amount of icons contained in the resource image given as columns and rows
          * \param iconSize The size of each icon given in pixels
          * \param parent The parent QObject
+         * \param options The options controlling the icon extraction
          */
         template < typename T, typename U >
-        QIconSet(T&& path, U&& colRow, U&& iconSize, QObject* parent = nullptr)
+        QIconSet(T&& path, U&& colRow, U&& iconSize, QObject* parent = nullptr, LoadOptions options = NoLoadOption)
             : QObject       (parent)
-            , m_iconset     (std::forward<T>(path))
+            , m_path        (std::forward<T>(path))
             , m_matrixSize  (std::forward<U>(colRow))
             , m_iconSize    (std::forward<U>(iconSize))
+            , m_options     (options)
+            , m_loaded      (true)
         {
             setup();
         }
@@ -63,10 +121,11 @@ namespace qtex
         * \param path The resource path of the icon set, e.g. ":/buttons/iconset.png"
         * \param colRow The amount of icons contained in the resource image given as columns and rows
         * \param parent The parent QObject
+        * \param options The options controlling the icon extraction
         */
         template < typename T, typename U >
-        QIconSet(T&& path, U&& colRow, QObject* parent = nullptr)
-            : QIconSet(std::forward<T>(path), std::forward<U>(colRow), QPoint(), parent)
+        QIconSet(T&& path, U&& colRow, QObject* parent = nullptr, LoadOptions options = NoLoadOption)
+            : QIconSet(std::forward<T>(path), std::forward<U>(colRow), QPoint(), parent, options)
         {
         }
 
@@ -77,10 +136,11 @@ namespace qtex
         * \param count The (maximum) amount of icons contained in the resource image
         * \param iconSize The size of each icon given in pixels
         * \param parent The parent QObject
+        * \param options The options controlling the icon extraction
         */
         template < typename T, typename U >
-        QIconSet(T&& path, int count, U&& iconSize, QObject* parent = nullptr)
-            : QIconSet(std::forward<T>(path), QPoint(count, 1), std::move(iconSize), parent)
+        QIconSet(T&& path, int count, U&& iconSize, QObject* parent = nullptr, LoadOptions options = NoLoadOption)
+            : QIconSet(std::forward<T>(path), QPoint(count, 1), std::move(iconSize), parent, options)
         {
         }
 
@@ -90,36 +150,236 @@ namespace qtex
          * \param path The resource path of the icon set, e.g. ":/buttons/iconset.png"
          * \param count The amount of icons contained in the resource image
          * \param parent The parent QObject
+         * \param options The options controlling the icon extraction
          */
         template < typename T >
-        QIconSet(T&& path, int count, QObject* parent = nullptr)
-            : QIconSet(std::forward<T>(path), QPoint(count, 1), QPoint(), parent)
+        QIconSet(T&& path, int count, QObject* parent = nullptr, LoadOptions options = NoLoadOption)
+            : QIconSet(std::forward<T>(path), QPoint(count, 1), QPoint(), parent, options)
         {
         }
 
         //! Move
         QIconSet(QIconSet&& src)
-            : m_iconset     (std::move(src.m_iconset))
+            : m_path        (std::move(src.m_path))
+            , m_iconset     (std::move(src.m_iconset))
             , m_icons       (std::move(src.m_icons))
+            , m_slots       (std::move(src.m_slots))
+            , m_bounds      (std::move(src.m_bounds))
+            , m_tiles       (std::move(src.m_tiles))
+            , m_mapping     (std::move(src.m_mapping))
+            , m_resolutions (std::move(src.m_resolutions))
+            , m_effects     (std::move(src.m_effects))
             , m_iconSize    (std::move(src.m_iconSize))
             , m_matrixSize  (std::move(src.m_matrixSize))
+            , m_options     (src.m_options)
+            , m_loaded      (src.m_loaded)
+            , m_invalidIcon (std::move(src.m_invalidIcon))
+            , m_hashes      (std::move(src.m_hashes))
+            , m_residencyTimeout(src.m_residencyTimeout)
+            , m_clock           (src.m_clock)
+            , m_lastUse         (std::move(src.m_lastUse))
+            , m_lastSheetUse    (src.m_lastSheetUse)
+            , m_compressed      (std::move(src.m_compressed))
+            , m_compressedSize  (src.m_compressedSize)
+            , m_sheetReleased   (src.m_sheetReleased)
+        {
+            setWatching(src.isWatching());
+            if(m_residencyTimeout)
+            {
+                // Keeps the last uses, unlike setResidencyTimeout()
+                startResidencyTimer();
+            }
+
+            // The timers of the source would keep reloading and dropping the moved-from state
+            src.setWatching(false);
+            delete src.m_residencyTimer;
+            src.m_residencyTimer   = nullptr;
+            src.m_residencyTimeout = 0;
+        }
+
+        /*!
+         * Creates an icon set which decodes its resource image in the background.
+         * The image is decoded and sliced on a worker thread, while the conversion into pixmaps
+         * happens on the GUI thread once done. Completion is signaled by loaded().
+         * \param path The resource path of the icon set, e.g. ":/buttons/iconset.png"
+         * \param colRow The (maximum) amount of icons contained in the resource image given as columns and rows
+         * \param iconSize The size of each icon given in pixels, a null size calculates it automatically
+         * \param parent The parent QObject
+         * \param options The options controlling the icon extraction
+         * \param pool The thread pool to decode (and slice with ParallelSlicing) in, if null the global thread pool is used
+         * \remark The icon set must not be moved before it has been loaded
+         * \returns The (not yet loaded) icon set, owned by parent
+         */
+        static QIconSet* loadAsync(const QString& path, const QPoint& colRow, const QPoint& iconSize = QPoint(),
+                                   QObject* parent = nullptr, LoadOptions options = NoLoadOption,
+                                   QThreadPool* pool = nullptr)
+        {
+            auto* iconSet = new QIconSet(path, colRow, iconSize, parent, options, Deferred());
+
+            // Pre-slicing only pays off if the icons get their own pixel copies right away
+            const auto slice   = !options.testFlag(LazyExtraction) && !options.testFlag(SharedSheet);
+            auto*      watcher = new QFutureWatcher<Sheet>(iconSet);
+
+            connect(watcher, &QFutureWatcher<Sheet>::finished, iconSet, [iconSet, watcher]()
+            {
+                iconSet->apply(watcher->result());
+                iconSet->m_loaded = true;
+                watcher->deleteLater();
+
+                emit iconSet->loaded();
+            });
+
+            watcher->setFuture(QtConcurrent::run(pool ? pool : QThreadPool::globalInstance(), [=]()
+            {
+                return decode(path, colRow, iconSize, options, slice, pool);
+            }));
+            return iconSet;
+        }
+
+        /*!
+         * Creates an icon set out of a binary cache file, falling back to the resource image if the cache
+         * file does not exist, is stale or does not match the requested layout. On fallback the cache file
+         * is (re)written, so the next call will hit the cache.
+         * \param cacheFile The path of the cache file
+         * \param path The resource path of the icon set, e.g. ":/buttons/iconset.png"
+         * \param colRow The (maximum) amount of icons contained in the resource image given as columns and rows
+         * \param iconSize The size of each icon given in pixels, a null size calculates it automatically
+         * \param parent The parent QObject
+         * \param options The options controlling the icon extraction
+         * \returns The icon set, owned by parent
+         */
+        static QIconSet* loadCached(const QString& cacheFile, const QString& path, const QPoint& colRow,
+                                    const QPoint& iconSize = QPoint(), QObject* parent = nullptr,
+                                    LoadOptions options = NoLoadOption)
+        {
+            auto* iconSet = new QIconSet(path, colRow, iconSize, parent, options, Deferred());
+
+            Sheet sheet;
+            if(readCache(cacheFile, path, colRow, iconSize, options, sheet))
+            {
+                QTEX_METRIC_COUNT("qiconset.cachefile.hit", path, 1);
+                iconSet->apply(std::move(sheet));
+
+                // Neither the image nor the tiles are kept, so re-extracting icons has to decode the image
+                if(iconSet->m_iconset.isNull() && iconSet->m_tiles.empty())
+                {
+                    iconSet->m_sheetReleased = true;
+                }
+            }
+            else
+            {
+                QTEX_METRIC_COUNT("qiconset.cachefile.miss", path, 1);
+                iconSet->setup();
+                iconSet->saveCache(cacheFile);
+            }
+
+            iconSet->m_loaded = true;
+            return iconSet;
+        }
+
+        /*!
+         * Writes the fully sliced icon set into a binary cache file which can be loaded via loadCached()
+         * \param cacheFile The path of the cache file
+         * \returns True on success
+         */
+        bool saveCache(const QString& cacheFile) const
+        {
+            if(!m_loaded || m_slots.empty())
+            {
+                return false;
+            }
+
+            QIconSetCacheFile::Content content;
+            content.matrixSize  = m_matrixSize;
+            content.iconSize    = m_iconSize;
+            content.skipEmpty   = m_options.testFlag(SkipEmptyTiles);
+            content.slotMap     = m_slots;
+            content.populated   = static_cast<int>(m_icons.size());
+
+            materialize();
+            const auto image = m_tiles.empty() ? m_iconset.toImage() : QImage();
+            if(m_tiles.empty() && image.isNull())
+            {
+                return false;
+            }
+
+            return QIconSetCacheFile::write(cacheFile, m_path, content, [this, &image](const int index)
+            {
+                return m_tiles.empty() ? image.copy(iconRect(index)) : m_tiles[m_slots[index]];
+            });
+        }
+
+        /*!
+         * Adds a high resolution variant of the icon set image, e.g. ":/buttons/iconset@2x.png".
+         * The variant must have the same matrix size with all icons scaled by the device pixel ratio.
+         * It is decoded only once an icon is requested at a pixel size exceeding the lower resolutions.
+         * \param path The resource path of the variant
+         * \param devicePixelRatio The device pixel ratio the variant is designed for, e.g. 2.0
+         * \remark Already extracted icons are replaced, so previously handed out icon copies won't pick it up
+         */
+        void addResolution(const QString& path, const qreal devicePixelRatio)
         {
+            if(!m_resolutions)
+            {
+                m_resolutions = std::make_shared<QIconSetResolutions>(m_matrixSize);
+            }
+            m_resolutions->add(path, devicePixelRatio);
+
+            reextractIcons();
+        }
+
+        /*!
+         * Sets the effect generating an icon mode (e.g. QIcon::Disabled) out of the normal icons.
+         * Icons sharing the icon set image generate the mode on its first request, all others
+         * register it via QIcon::addPixmap() when the icon is extracted.
+         * \param mode The icon mode, QIcon::Normal is ignored
+         * \param effect The effect, a null effect restores the default, QIconEffect::disabled()
+         *        for QIcon::Disabled and the normal icons for all other modes
+         * \remark Already extracted icons are replaced, so previously handed out icon copies won't pick it up
+         */
+        void setModeEffect(const QIcon::Mode mode, const QIconEffect& effect)
+        {
+            if(mode == QIcon::Normal)
+            {
+                return;
+            }
+
+            auto effects = m_effects ? std::make_shared<QIconEffects>(*m_effects) : std::make_shared<QIconEffects>();
+            (*effects)[mode] = effect;
+            m_effects = std::move(effects);
+
+            reextractIcons();
         }
 
         /*!
          * Get an icon at the specified 1D position (zero-based index) in the icon set
          * \param index The column index of the icon
          * \remark The row index is assumed to be always 0
+         * \remark With LazyExtraction the icon is extracted and cached on its first request
+         * \remark With a residency timeout the icon is re-extracted if it has been dropped, keep a copy of
+         * the icon rather than the reference since the reference turns null once the icon is dropped
          * \returns The icon as a QIcon
          */
         const QIcon& getIcon(const int index) const
         {
-            Q_ASSERT(isValid(index));
-            if(index >= static_cast<int>(m_icons.size()))
+            Q_ASSERT(!m_loaded || isValid(index));
+            if(!isValid(index))
             {
                 return m_invalidIcon;
             }
-            return m_icons[index];
+
+            const auto slot = m_slots[index];
+            if(m_residencyTimer)
+            {
+                touch(slot);
+            }
+
+            auto& icon = m_icons[slot];
+            if(icon.isNull() && (m_options.testFlag(LazyExtraction) || m_residencyTimer))
+            {
+                icon = extractIcon(index);
+            }
+            return icon;
         }
 
         /*!
@@ -134,7 +394,7 @@ namespace qtex
         {
             static_assert(std::is_enum<ColType>::value, "ColType must be of enum type");
 
-            Q_ASSERT(isValid(underlying(index)));
+            Q_ASSERT(!m_loaded || isValid(underlying(index)));
 
             return getIcon(underlying(index));
         }
@@ -147,9 +407,9 @@ namespace qtex
          */
         const QIcon& getIcon(const int col, const int row) const
         {
-            Q_ASSERT(isValid(col, row));
+            Q_ASSERT(!m_loaded || isValid(col, row));
 
-            return m_icons[toIndex(col, row)];
+            return getIcon(toIndex(col, row));
         }
 
         /*!
@@ -164,7 +424,7 @@ namespace qtex
             static_assert(std::is_enum<ColType>::value, "ColType must be of enum type");
             static_assert(std::is_enum<RowType>::value, "RowType must be of enum type");
 
-            Q_ASSERT(isValid(underlying(col), underlying(row)));
+            Q_ASSERT(!m_loaded || isValid(underlying(col), underlying(row)));
 
             return getIcon(underlying(col), underlying(row));
         }
@@ -177,18 +437,19 @@ namespace qtex
          */
         bool isValid(const int col, const int row) const Q_DECL_NOEXCEPT
         {
-            return toIndex(col, row) < static_cast<int>(m_icons.size());
+            return isValid(toIndex(col, row));
         }
 
         /*!
          * Check if there is an icon at the specified 1D position
          * \param col The column index of the icon
          * \remark The row index is assumed to be 0
+         * \remark Empty icon areas skipped by SkipEmptyTiles are not valid
          * \returns True if an icon exists at the given position
          */
         bool isValid(const int index) const Q_DECL_NOEXCEPT
         {
-            return index < static_cast<int>(m_icons.size());
+            return index >= 0 && index < static_cast<int>(m_slots.size()) && m_slots[index] >= 0;
         }
 
         /*!
@@ -209,42 +470,937 @@ namespace qtex
             return m_iconSize.x() * 0.5;
         }
 
+        /*!
+         * Retrieves the icon set matrix size
+         * \returns The amount of columns as x-component and the amount of rows as y-component
+         */
+        const QPoint& getMatrixSize() const Q_DECL_NOEXCEPT
+        {
+            return m_matrixSize;
+        }
+
+        /*!
+         * Retrieves the whole icon set image, e.g. to upload it as a single texture (see QIconSetTexture)
+         * \remark Icon sets not keeping the image (e.g. loaded by loadCached() without SharedSheet) decode it again
+         * \returns The icon set image
+         */
+        QImage getSheetImage() const
+        {
+            materialize();
+            return m_iconset.toImage();
+        }
+
+        /*!
+         * Calculates the area of an icon within the icon set image in normalized texture coordinates
+         * \param index The 1D index of the icon
+         * \returns The area with coordinates in [0, 1], a null rectangle for invalid icons
+         */
+        QRectF getTextureRect(const int index) const
+        {
+            if(!isValid(index))
+            {
+                return QRectF();
+            }
+
+            const auto   position = fromIndex(index);
+            const QSizeF sheet    = !m_iconset.isNull()   ? QSizeF(m_iconset.size())
+                                  : !m_compressed.isEmpty() ? QSizeF(m_compressedSize)
+                                                            : QSizeF(m_matrixSize.x() * m_iconSize.x(),
+                                                                     m_matrixSize.y() * m_iconSize.y());
+            return QRectF(position.x() * m_iconSize.x() / sheet.width(), position.y() * m_iconSize.y() / sheet.height(),
+                          m_iconSize.x() / sheet.width(), m_iconSize.y() / sheet.height());
+        }
+
+        /*!
+         * Estimates the memory currently resident for the icon set image and its extracted icons
+         * \remark Icons sharing the icon set image (SharedSheet) don't count as they own no pixels
+         * \returns The approximate amount of bytes
+         */
+        qint64 getMemoryUsage() const Q_DECL_NOEXCEPT
+        {
+            const auto depth = static_cast<qint64>(m_iconset.isNull() ? 4 : m_iconset.depth() / 8);
+            auto       bytes = static_cast<qint64>(m_iconset.width()) * m_iconset.height() * depth + m_compressed.size();
+            if(!m_options.testFlag(SharedSheet))
+            {
+                const auto iconBytes = static_cast<qint64>(m_iconSize.x()) * m_iconSize.y() * depth;
+                const auto count     = static_cast<int>(m_icons.size());
+                for(auto slot = 0; slot < count; ++slot)
+                {
+                    if(!m_icons[slot].isNull())
+                    {
+                        bytes += isTrimmed() ? static_cast<qint64>(m_bounds[slot].width()) * m_bounds[slot].height() * depth
+                                             : iconBytes;
+                    }
+                }
+            }
+            return bytes + (m_resolutions ? m_resolutions->getMemoryUsage() : 0);
+        }
+
+        /*!
+         * Check if the icon set image has been loaded
+         * \remark Only icon sets created by loadAsync() are not loaded right from the start
+         * \returns True if the icons are available
+         */
+        bool isLoaded() const Q_DECL_NOEXCEPT
+        {
+            return m_loaded;
+        }
+
+        /*!
+         * Sets the icon returned for invalid icon requests and while the icon set is not loaded yet
+         * \param icon The placeholder icon
+         */
+        void setPlaceholderIcon(const QIcon& icon)
+        {
+            m_invalidIcon = icon;
+        }
+
+        /*!
+         * Retrieves the options the icon set has been constructed with
+         * \returns The load options
+         */
+        LoadOptions getLoadOptions() const Q_DECL_NOEXCEPT
+        {
+            return m_options;
+        }
+
+        /*!
+         * Sets the time after which unused icons are dropped to cap the resident memory.
+         * Dropped icons are re-extracted on their next request by getIcon(). Once no icon has been requested
+         * for the given time, the icon set image itself is kept compressed until the next request.
+         * \param msecs The time in milliseconds, 0 to keep all icons resident (the default), which re-extracts
+         * the dropped icons unless extracted lazily
+         * \remark Only the memory of icons without copies held elsewhere (e.g. by widgets) is actually freed
+         */
+        void setResidencyTimeout(const int msecs)
+        {
+            m_residencyTimeout = qMax(0, msecs);
+            if(!m_residencyTimeout)
+            {
+                delete m_residencyTimer;
+                m_residencyTimer = nullptr;
+                m_lastUse.clear();
+
+                // Without the timer getIcon() no longer re-extracts dropped icons, only lazily extracted ones
+                if(!m_options.testFlag(LazyExtraction))
+                {
+                    const auto released = m_sheetReleased;
+                    const auto count    = static_cast<int>(m_slots.size());
+                    for(auto index = 0; index < count; ++index)
+                    {
+                        const auto slot = m_slots[index];
+                        if(slot >= 0 && m_icons[slot].isNull())
+                        {
+                            m_icons[slot] = extractIcon(index);
+                        }
+                    }
+                    if(!m_compressed.isEmpty())
+                    {
+                        materialize();
+                    }
+                    releaseSheet(released);
+                }
+                return;
+            }
+
+            if(!m_residencyTimer)
+            {
+                m_clock.start();
+            }
+            m_lastUse.assign(m_icons.size(), m_clock.elapsed());
+            m_lastSheetUse = m_clock.elapsed();
+            startResidencyTimer();
+        }
+
+        //! The time after which unused icons are dropped, 0 if all icons are kept resident
+        int getResidencyTimeout() const Q_DECL_NOEXCEPT
+        {
+            return m_residencyTimeout;
+        }
+
+        /*!
+         * Watches the icon set image file and reloads it once it changed on disk, see reload()
+         * \param watch True to watch, false to stop watching
+         * \remark Resource paths (e.g. ":/buttons/iconset.png") can't change and thus are not watched
+         */
+        void setWatching(const bool watch)
+        {
+            if(watch == isWatching())
+            {
+                return;
+            }
+
+            if(!watch)
+            {
+                delete m_watcher;
+                delete m_reloadTimer;
+                m_watcher     = nullptr;
+                m_reloadTimer = nullptr;
+                releaseSheet();
+                return;
+            }
+
+            materialize();
+            if(m_hashes.empty() && !m_iconset.isNull())
+            {
+                m_hashes = tileHashes(m_iconset.toImage(), m_matrixSize, m_iconSize);
+            }
+
+            // Editors usually write in several steps, so reload once the file settled
+            m_reloadTimer = new QTimer(this);
+            m_reloadTimer->setSingleShot(true);
+            m_reloadTimer->setInterval(200);
+            connect(m_reloadTimer, &QTimer::timeout, this, &QIconSet::reload);
+
+            m_watcher = new QFileSystemWatcher(this);
+            m_watcher->addPath(m_path);
+            connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString& path)
+            {
+                // Saving by replacing the file removes it from the watcher
+                if(!m_watcher->files().contains(path) && QFile::exists(path))
+                {
+                    m_watcher->addPath(path);
+                }
+                m_reloadTimer->start();
+            });
+        }
+
+        //! True if the icon set image file is watched, see setWatching()
+        bool isWatching() const Q_DECL_NOEXCEPT
+        {
+            return m_watcher != nullptr;
+        }
+
+        /*!
+         * Decodes the icon set image again and re-extracts only the icons whose pixels changed.
+         * The icons are updated in place, so the references returned by getIcon() stay valid and paint
+         * the new pixels, while copies of them keep the previous ones. Emits iconsChanged() for the
+         * changed icons.
+         * \remark Icons appearing in previously empty areas (see SkipEmptyTiles) may invalidate the references
+         * \remark The high resolution variants (see addResolution()) are not reloaded
+         * \remark With SharedSheet all extracted icons are rebuilt on the new image, copies of them keep
+         *         the previous image alive until they are released
+         */
+        void reload()
+        {
+            if(!m_loaded)
+            {
+                return;
+            }
+
+            auto sheet = decode(m_path, m_matrixSize, m_iconSize, m_options, false, nullptr);
+            if(sheet.image.isNull() || sheet.iconSize != m_iconSize)
+            {
+                // E.g. the file is being written
+                return;
+            }
+
+            auto hashes = tileHashes(sheet.image, m_matrixSize, m_iconSize);
+            if(hashes == m_hashes)
+            {
+                return;
+            }
+            m_iconset       = QPixmap::fromImage(std::move(sheet.image));
+            m_sheetReleased = false;
+            m_compressed.clear();
+
+            // The cached icons are outdated now
+            m_tiles.clear();
+            m_mapping.reset();
+
+            QVector<int> changed;
+            const auto   count  = static_cast<int>(m_slots.size());
+            const auto   shared = m_options.testFlag(SharedSheet);
+            for(auto index = 0; index < count; ++index)
+            {
+                if(!m_hashes.empty() && hashes[index] == m_hashes[index])
+                {
+                    // Shared icons still paint the previous image, rebuild them to release it
+                    const auto slot = m_slots[index];
+                    if(shared && slot >= 0 && !m_icons[slot].isNull())
+                    {
+                        m_icons[slot] = extractIcon(index);
+                    }
+                    continue;
+                }
+
+                changed.append(index);
+                const auto source = sheet.slotMap[index];
+                auto&      slot   = m_slots[index];
+                if(source < 0)
+                {
+                    // Now empty, the slot is left as a hole
+                    if(slot >= 0)
+                    {
+                        m_icons[slot] = QIcon();
+                        slot          = -1;
+                    }
+                    continue;
+                }
+
+                if(slot < 0)
+                {
+                    slot = static_cast<int>(m_icons.size());
+                    m_icons.emplace_back();
+                    if(!m_bounds.empty())
+                    {
+                        m_bounds.emplace_back();
+                    }
+                }
+                if(!m_bounds.empty() && !sheet.bounds.empty())
+                {
+                    m_bounds[slot] = sheet.bounds[source];
+                }
+
+                // Lazily extracted icons are only replaced if they have been requested before
+                if(!m_options.testFlag(LazyExtraction) || !m_icons[slot].isNull())
+                {
+                    m_icons[slot] = extractIcon(index);
+                }
+            }
+
+            m_hashes = std::move(hashes);
+            releaseSheet();
+            if(!changed.isEmpty())
+            {
+                emit iconsChanged(changed);
+            }
+        }
+
+    signals:
+        //! Emitted once an icon set created by loadAsync() has been loaded
+        void loaded();
+
+        //! Emitted by reload() with the 1D indices of the icons that changed
+        void iconsChanged(const QVector<int>& indices);
+
     private:
-        QPixmap            m_iconset;       //<! The original icon set
-        std::vector<QIcon> m_icons;         //<! All extracted icons
-        QPoint             m_matrixSize;    //<! The icon set matrix size
-        QPoint             m_iconSize;      //<! The size of each icon
-        QIcon              m_invalidIcon;   //<! Can be returned in case of an icon failure
+        QString                     m_path;          //<! The resource path of the icon set
+        mutable QPixmap             m_iconset;       //<! The original icon set, null while compressed
+        mutable std::vector<QIcon>  m_icons;         //<! All extracted icons (null until extracted in lazy mode)
+        std::vector<int>            m_slots;         //<! Maps a 1D index to its slot in m_icons, -1 for empty areas
+        std::vector<QRect>          m_bounds;        //<! The opaque area of each slot within its cell, if trimmed
+        std::vector<QImage>         m_tiles;         //<! Memory-mapped icons of a cache file, only kept in lazy mode
+        std::shared_ptr<QFile>      m_mapping;       //<! The cache file m_tiles are mapped from
+        std::shared_ptr<QIconSetResolutions> m_resolutions; //<! The optional high resolution variants
+        std::shared_ptr<const QIconEffects>  m_effects;     //<! The optional effects generating the icon modes
+        QPoint                      m_matrixSize;    //<! The icon set matrix size
+        QPoint                      m_iconSize;      //<! The size of each icon
+        LoadOptions                 m_options;       //<! The options controlling the icon extraction
+        bool                        m_loaded;        //<! False while the icon set image is decoded in the background
+        QIcon                       m_invalidIcon;   //<! Can be returned in case of an icon failure
+        std::vector<uint>           m_hashes;        //<! The pixel hash of each icon area, only while watching
+        QFileSystemWatcher*         m_watcher     = nullptr; //<! Watches the icon set image file, see setWatching()
+        QTimer*                     m_reloadTimer = nullptr; //<! Delays reload() until the file settled
+        QTimer*                     m_residencyTimer = nullptr; //<! Drops the idle icons, see setResidencyTimeout()
+        int                         m_residencyTimeout = 0;     //<! The time in ms after which unused icons are dropped
+        QElapsedTimer               m_clock;                    //<! The time base of the last uses
+        mutable std::vector<qint64> m_lastUse;                  //<! The time of the last request of each slot
+        mutable qint64              m_lastSheetUse = 0;         //<! The time of the last request of any icon
+        mutable QByteArray          m_compressed;               //<! The compressed icon set image while idle
+        QSize                       m_compressedSize;           //<! The size of the compressed icon set image
+        mutable bool                m_sheetReleased = false;    //<! True if the icon set image is decoded again on demand
+
+        //! The decoded icon set image, only consisting of thread-safe image data
+        struct Sheet
+        {
+            QImage              image;          //<! The decoded icon set image
+            QPoint              iconSize;       //<! The (possibly calculated) size of each icon
+            std::vector<int>    slotMap;        //<! The index map, -1 for empty icon areas
+            int                 populated = 0;  //<! The amount of non-empty icons
+            std::vector<QImage> tiles;          //<! The pre-sliced non-empty icons, if requested (trimmed to bounds)
+            std::vector<QRect>  bounds;         //<! The opaque area of each non-empty icon within its cell, if trimmed
+            std::shared_ptr<QFile> mapping;     //<! The cache file the tiles are mapped from, if any
+        };
+
+        //! Tag selecting the constructor which defers loading to loadAsync()
+        struct Deferred {};
+
+        QIconSet(const QString& path, const QPoint& colRow, const QPoint& iconSize, QObject* parent,
+                 LoadOptions options, Deferred)
+            : QObject       (parent)
+            , m_path        (path)
+            , m_matrixSize  (colRow)
+            , m_iconSize    (iconSize)
+            , m_options     (options)
+            , m_loaded      (false)
+        {
+        }
 
         void setup()
         {
-            if(m_iconset.isNull())
+            // Slicing in parallel leaves only the pixmap conversion to the calling thread
+            const auto slice = m_options.testFlag(ParallelSlicing) && !m_options.testFlag(LazyExtraction) &&
+                               !m_options.testFlag(SharedSheet);
+            apply(decode(m_path, m_matrixSize, m_iconSize, m_options, slice, nullptr));
+        }
+
+        /*!
+         * Decodes the icon set image and builds the index map. Only touches image data so it is safe
+         * to be called from any thread.
+         * \param path The resource path of the icon set
+         * \param matrixSize The icon set matrix size
+         * \param iconSize The size of each icon, a null size calculates it automatically
+         * \param options The options controlling the icon extraction
+         * \param slice If true the non-empty icons are sliced into separate images
+         * \param pool The thread pool slicing the rows with ParallelSlicing, if null the global thread pool is used
+         * \returns The decoded icon set image
+         */
+        static Sheet decode(const QString& path, const QPoint& matrixSize, const QPoint& iconSize,
+                            const LoadOptions options, const bool slice, QThreadPool* pool)
+        {
+            QTEX_METRIC_SCOPED_TIMER("qiconset.decode", path);
+
+            Sheet sheet;
+            sheet.image = QImage(path);
+            if(sheet.image.isNull())
+            {
+                return sheet;
+            }
+
+            // If null we auto calculate the icon size out of the colRow infos
+            sheet.iconSize = iconSize;
+            if(sheet.iconSize.isNull())
+            {
+                sheet.iconSize.setX(sheet.image.width() / matrixSize.x());
+                sheet.iconSize.setY(sheet.image.height() / matrixSize.y());
+            }
+
+            // Premultiplied pixels are all-zero if transparent which makes the emptiness check a plain OR
+            const auto skipEmpty = options.testFlag(SkipEmptyTiles) && sheet.image.hasAlphaChannel();
+            const auto trim      = options.testFlag(TrimTransparentBorders) && !options.testFlag(SharedSheet) &&
+                                   sheet.image.hasAlphaChannel();
+            if(skipEmpty || trim)
+            {
+                sheet.image = sheet.image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            }
+
+            // Each row only writes its own elements of the pre-sized vectors, so rows need no locking.
+            // Not a std::vector<bool> as its elements can't be written concurrently.
+            const auto          count = matrixSize.x() * matrixSize.y();
+            std::vector<char>   empty(count, 0);
+            std::vector<QImage> cells(slice ? count : 0);
+            std::vector<QRect>  areas(trim ? count : 0);
+
+            const QImage& image    = sheet.image;
+            const auto    cellSize = sheet.iconSize;
+            const auto    sliceRow = [&](const int row)
+            {
+                for(auto index = row * matrixSize.x(); index < (row + 1) * matrixSize.x(); ++index)
+                {
+                    const auto rect = iconRect(index, matrixSize, cellSize);
+                    if(trim)
+                    {
+                        areas[index] = opaqueBounds(image, rect);
+                        empty[index] = skipEmpty && areas[index].isEmpty();
+                    }
+                    else
+                    {
+                        empty[index] = skipEmpty && isTransparent(image, rect);
+                    }
+
+                    if(slice && !empty[index])
+                    {
+                        cells[index] = trim ? copyArea(image, areas[index].translated(rect.topLeft())) : image.copy(rect);
+                    }
+                }
+            };
+
+            if(options.testFlag(ParallelSlicing) && matrixSize.y() > 1)
+            {
+                std::vector<QFuture<void>> rows;
+                rows.reserve(matrixSize.y());
+                for(auto row = 0; row < matrixSize.y(); ++row)
+                {
+                    rows.push_back(QtConcurrent::run(pool ? pool : QThreadPool::globalInstance(), sliceRow, row));
+                }
+                for(auto& row : rows)
+                {
+                    row.waitForFinished();
+                }
+            }
+            else
+            {
+                for(auto row = 0; row < matrixSize.y(); ++row)
+                {
+                    sliceRow(row);
+                }
+            }
+
+            // Build the index map, empty icon areas don't get a slot
+            sheet.slotMap.reserve(count);
+            for(auto index = 0; index < count; ++index)
+            {
+                sheet.slotMap.push_back(empty[index] ? -1 : sheet.populated++);
+                if(slice && !empty[index])
+                {
+                    sheet.tiles.push_back(std::move(cells[index]));
+                }
+                if(trim && !empty[index])
+                {
+                    sheet.bounds.push_back(areas[index]);
+                }
+            }
+            return sheet;
+        }
+
+        /*!
+         * Takes over a decoded icon set image and extracts the icons. Must be called from the GUI thread.
+         * \param sheet The decoded icon set image
+         */
+        void apply(Sheet sheet)
+        {
+            QTEX_METRIC_COUNT("qiconset.tiles", m_path, sheet.populated);
+            extract(std::move(sheet));
+            releaseSheet();
+            QTEX_METRIC_GAUGE("qiconset.bytes", m_path, getMemoryUsage());
+        }
+
+        //! See apply()
+        void extract(Sheet sheet)
+        {
+            if(sheet.image.isNull() && sheet.tiles.empty())
             {
                 Q_ASSERT(false);
                 return;
             }
 
-            // If null we auto calculate the icon size out of the colRow infos
-            if(iconSize.isNull())
+            m_iconSize = sheet.iconSize;
+            m_slots    = std::move(sheet.slotMap);
+            m_bounds   = std::move(sheet.bounds);
+            if(!sheet.image.isNull())
             {
-                m_iconSize.setX(m_iconset.width() / colRow.x());
-                m_iconSize.setY(m_iconset.height() / colRow.y());
+                m_iconset = QPixmap::fromImage(std::move(sheet.image));
+            }
+
+            // In lazy mode only the (null) slots are allocated, icons are extracted on request
+            if(m_options.testFlag(LazyExtraction))
+            {
+                m_tiles   = std::move(sheet.tiles);
+                m_mapping = std::move(sheet.mapping);
+                m_icons.resize(sheet.populated);
+                return;
             }
 
             // Now retrieve all icons from the icon set.
-            m_icons.reserve(m_matrixSize.x() * m_matrixSize.y());
-            for(auto y = 0; y < m_matrixSize.y(); ++y)
+            m_icons.reserve(sheet.populated);
+            if(!sheet.tiles.empty())
+            {
+                for(auto& tile : sheet.tiles)
+                {
+                    auto pmap = QPixmap::fromImage(std::move(tile));
+                    m_icons.emplace_back(isTrimmed() ? trimmedIcon(pmap, static_cast<int>(m_icons.size()))
+                                                     : QIcon(pmap));
+                }
+                return;
+            }
+
+            const auto count = static_cast<int>(m_slots.size());
+            for(auto index = 0; index < count; ++index)
+            {
+                if(m_slots[index] >= 0)
+                {
+                    m_icons.emplace_back(extractIcon(index));
+                }
+            }
+        }
+
+        /*!
+         * Reads a binary cache file written by saveCache()
+         * \param cacheFile The path of the cache file
+         * \param path The resource path of the icon set the cache file must have been created from
+         * \param matrixSize The icon set matrix size
+         * \param iconSize The size of each icon, a null size accepts any
+         * \param options The options controlling the icon extraction
+         * \param sheet Receives the icon set layout and the icons
+         * \returns False if the cache file can't be used
+         */
+        static bool readCache(const QString& cacheFile, const QString& path, const QPoint& matrixSize,
+                              const QPoint& iconSize, const LoadOptions options, Sheet& sheet)
+        {
+            QIconSetCacheFile::Content content;
+            if(!QIconSetCacheFile::read(cacheFile, path, content) || content.matrixSize != matrixSize ||
+               (!iconSize.isNull() && content.iconSize != iconSize) ||
+               content.skipEmpty != options.testFlag(SkipEmptyTiles))
+            {
+                return false;
+            }
+
+            sheet.iconSize  = content.iconSize;
+            sheet.slotMap   = std::move(content.slotMap);
+            sheet.populated = content.populated;
+
+            if(options.testFlag(SharedSheet))
+            {
+                // Shared icons need the whole icon set image, so reassemble it out of the icons
+                sheet.image = QImage(matrixSize.x() * sheet.iconSize.x(), matrixSize.y() * sheet.iconSize.y(),
+                                     QImage::Format_ARGB32_Premultiplied);
+                sheet.image.fill(0);
+
+                const auto lineBytes = sheet.iconSize.x() * 4;
+                const auto count     = static_cast<int>(sheet.slotMap.size());
+                for(auto index = 0; index < count; ++index)
+                {
+                    if(sheet.slotMap[index] < 0)
+                    {
+                        continue;
+                    }
+
+                    const auto& tile = content.tiles[sheet.slotMap[index]];
+                    const auto  rect = iconRect(index, matrixSize, sheet.iconSize);
+                    for(auto y = 0; y < rect.height(); ++y)
+                    {
+                        std::memcpy(sheet.image.scanLine(rect.y() + y) + rect.x() * 4, tile.constScanLine(y),
+                                    lineBytes);
+                    }
+                }
+            }
+            else
+            {
+                // The cache file stores whole cells, so the bounds are recomputed out of them
+                if(options.testFlag(TrimTransparentBorders))
+                {
+                    sheet.bounds.reserve(content.tiles.size());
+                    for(const auto& tile : content.tiles)
+                    {
+                        sheet.bounds.push_back(tile.format() == QImage::Format_ARGB32_Premultiplied
+                                                   ? opaqueBounds(tile, tile.rect()) : tile.rect());
+                    }
+                }
+
+                if(options.testFlag(LazyExtraction))
+                {
+                    // Keep the icons mapped, they are only copied once requested
+                    sheet.tiles   = std::move(content.tiles);
+                    sheet.mapping = std::move(content.mapping);
+                }
+                else
+                {
+                    // Detach right away so no pixmap ever references the mapping
+                    sheet.tiles.reserve(content.tiles.size());
+                    for(auto slot = 0; slot < static_cast<int>(content.tiles.size()); ++slot)
+                    {
+                        const auto& tile = content.tiles[slot];
+                        sheet.tiles.push_back(sheet.bounds.empty() ? tile.copy() : copyArea(tile, sheet.bounds[slot]));
+                    }
+                }
+            }
+            return true;
+        }
+
+        /*!
+         * Checks if an area of a premultiplied ARGB32 image is fully transparent
+         * \param image The image, must be of format QImage::Format_ARGB32_Premultiplied
+         * \param rect The area to check, clipped to the image bounds
+         * \returns True if all pixels within the area are fully transparent
+         */
+        static bool isTransparent(const QImage& image, const QRect& rect) Q_DECL_NOEXCEPT
+        {
+            Q_ASSERT(image.format() == QImage::Format_ARGB32_Premultiplied);
+
+            const auto area = rect.intersected(image.rect());
+            for(auto y = area.top(); y <= area.bottom(); ++y)
+            {
+                // Branch-free OR reduction per scanline so the compiler can vectorize the inner loop
+                const auto* line  = reinterpret_cast<const quint32*>(image.constScanLine(y)) + area.left();
+                quint32     pixel = 0;
+                for(auto x = 0; x < area.width(); ++x)
+                {
+                    pixel |= line[x];
+                }
+
+                if(pixel != 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /*!
+         * Computes the opaque bounding box of an area of a premultiplied ARGB32 image
+         * \param image The image, must be of format QImage::Format_ARGB32_Premultiplied
+         * \param rect The area to check, clipped to the image bounds
+         * \returns The bounding box of all non-transparent pixels relative to the area, empty if fully transparent
+         */
+        static QRect opaqueBounds(const QImage& image, const QRect& rect) Q_DECL_NOEXCEPT
+        {
+            Q_ASSERT(image.format() == QImage::Format_ARGB32_Premultiplied);
+
+            const auto area   = rect.intersected(image.rect());
+            auto       left   = area.right() + 1;
+            auto       right  = area.left() - 1;
+            auto       top    = -1;
+            auto       bottom = -1;
+            for(auto y = area.top(); y <= area.bottom(); ++y)
+            {
+                const auto* line  = reinterpret_cast<const quint32*>(image.constScanLine(y));
+                quint32     pixel = 0;
+                for(auto x = area.left(); x <= area.right(); ++x)
+                {
+                    pixel |= line[x];
+                }
+                if(pixel == 0)
+                {
+                    continue;
+                }
+
+                top    = top < 0 ? y : top;
+                bottom = y;
+
+                // Only the columns outside of the current box can widen it
+                for(auto x = area.left(); x < left; ++x)
+                {
+                    if(line[x] != 0)
+                    {
+                        left = x;
+                        break;
+                    }
+                }
+                for(auto x = area.right(); x > right; --x)
+                {
+                    if(line[x] != 0)
+                    {
+                        right = x;
+                        break;
+                    }
+                }
+            }
+
+            if(top < 0)
+            {
+                return QRect();
+            }
+            return QRect(QPoint(left, top), QPoint(right, bottom)).translated(-rect.topLeft());
+        }
+
+        /*!
+         * Hashes the pixels of each icon area
+         * \param image The icon set image
+         * \param matrixSize The icon set matrix size
+         * \param iconSize The size of each icon
+         * \returns The hash of each icon area by its 1D index
+         */
+        static std::vector<uint> tileHashes(const QImage& image, const QPoint& matrixSize, const QPoint& iconSize)
+        {
+            // The icon set image is kept premultiplied, the decoded one isn't, so hash a common format
+            const auto pixels = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            const auto count  = matrixSize.x() * matrixSize.y();
+
+            std::vector<uint> hashes;
+            hashes.reserve(count);
+            for(auto index = 0; index < count; ++index)
+            {
+                const auto area = iconRect(index, matrixSize, iconSize).intersected(pixels.rect());
+
+                uint hash = 0;
+                for(auto y = area.top(); y <= area.bottom(); ++y)
+                {
+                    hash = qHashBits(pixels.constScanLine(y) + area.left() * 4, area.width() * 4, hash);
+                }
+                hashes.push_back(hash);
+            }
+            return hashes;
+        }
+
+        //! Copies an area of an image, unlike QImage::copy() an empty area results in a null image
+        static QImage copyArea(const QImage& image, const QRect& area)
+        {
+            return area.isEmpty() ? QImage() : image.copy(area);
+        }
+
+        //! True if the icons only keep the pixels of their opaque bounding box
+        bool isTrimmed() const Q_DECL_NOEXCEPT
+        {
+            return !m_bounds.empty() && !m_resolutions && !m_options.testFlag(SharedSheet);
+        }
+
+        /*!
+         * Creates a trimmed icon
+         * \param pmap The pixels of the opaque bounding box of the icon
+         * \param slot The slot of the icon
+         * \returns The icon painting the pixels at their offset within the cell
+         */
+        QIcon trimmedIcon(const QPixmap& pmap, const int slot) const
+        {
+            const auto& bounds = m_bounds[slot];
+            return QIcon(new QTrimmedIconEngine(pmap, bounds.topLeft(), QSize(m_iconSize.x(), m_iconSize.y()),
+                                                m_effects));
+        }
+
+        /*!
+         * Extracts a single icon out of the icon set image
+         * \param index The 1D index of the icon
+         * \returns The extracted icon, either as a pixel copy or sharing the icon set image
+         */
+        QIcon extractIcon(const int index) const
+        {
+            materialize();
+            if(m_options.testFlag(SharedSheet))
+            {
+                return QIcon(new QIconSetEngine(m_iconset, iconRect(index), m_resolutions, index, m_effects));
+            }
+
+            if(isTrimmed())
+            {
+                const auto slot   = m_slots[index];
+                const auto bounds = m_bounds[slot];
+                if(bounds.isEmpty())
+                {
+                    return trimmedIcon(QPixmap(), slot);
+                }
+                return trimmedIcon(m_tiles.empty() ? m_iconset.copy(bounds.translated(iconRect(index).topLeft()))
+                                                   : QPixmap::fromImage(m_tiles[slot].copy(bounds)), slot);
+            }
+
+            // Detach from the memory-mapped cache file, if any
+            const auto pmap = m_tiles.empty() ? m_iconset.copy(iconRect(index))
+                                              : QPixmap::fromImage(m_tiles[m_slots[index]].copy());
+            if(m_resolutions)
+            {
+                return QIcon(new QIconSetEngine(pmap, pmap.rect(), m_resolutions, index, m_effects));
+            }
+
+            QIcon icon(pmap);
+            for(auto mode = 1; m_effects && mode < static_cast<int>(m_effects->size()); ++mode)
+            {
+                const auto& effect = (*m_effects)[mode];
+                if(!effect.isNull())
+                {
+                    icon.addPixmap(effect.apply(pmap), static_cast<QIcon::Mode>(mode));
+                }
+            }
+            return icon;
+        }
+
+        //! Records the request of an icon for the residency timeout
+        void touch(const int slot) const
+        {
+            if(slot >= static_cast<int>(m_lastUse.size()))
+            {
+                m_lastUse.resize(m_icons.size(), 0);
+            }
+            m_lastUse[slot] = m_lastSheetUse = m_clock.elapsed();
+        }
+
+        //! Creates the residency timer if needed and (re)starts it for the current timeout
+        void startResidencyTimer()
+        {
+            if(!m_residencyTimer)
+            {
+                m_residencyTimer = new QTimer(this);
+                connect(m_residencyTimer, &QTimer::timeout, this, &QIconSet::dropIdle);
+            }
+            m_residencyTimer->start(qMax(m_residencyTimeout / 2, 100));
+        }
+
+        //! Drops the icons not requested within the residency timeout, compresses the image once all are idle
+        void dropIdle()
+        {
+            const auto now   = m_clock.elapsed();
+            const auto count = qMin(m_icons.size(), m_lastUse.size());
+            for(std::size_t slot = 0; slot < count; ++slot)
             {
-                auto pos_iy = m_iconSize.y() * y;
-                for(auto x = 0; x < m_matrixSize.x(); ++x)
+                if(!m_icons[slot].isNull() && now - m_lastUse[slot] >= m_residencyTimeout)
                 {
-                    const auto pos_ix = m_iconSize.x() * x;
-                    auto       pmap   = m_iconset.copy(pos_ix, pos_iy, m_iconSize.x(), m_iconSize.y());
+                    m_icons[slot] = QIcon();
+                }
+            }
+
+            if(now - m_lastSheetUse < m_residencyTimeout || m_iconset.isNull())
+            {
+                return;
+            }
+
+            // Premultiplied ARGB32 is what the pixmap is converted back from cheapest
+            const auto image = m_iconset.toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            m_compressed     = qCompress(image.constBits(), image.bytesPerLine() * image.height(), 1);
+            m_compressedSize = image.size();
+            m_iconset        = QPixmap();
+        }
+
+        //! Decompresses the icon set image, if compressed by the residency timeout, or decodes it if released
+        void materialize() const
+        {
+            if(m_sheetReleased)
+            {
+                m_iconset       = QPixmap::fromImage(QImage(m_path));
+                m_sheetReleased = false;
+                return;
+            }
+
+            if(m_compressed.isEmpty())
+            {
+                return;
+            }
+
+            const auto pixels = qUncompress(m_compressed);
+            QImage     image(m_compressedSize, QImage::Format_ARGB32_Premultiplied);
+            if(pixels.size() == image.bytesPerLine() * image.height())
+            {
+                std::memcpy(image.bits(), pixels.constData(), pixels.size());
+                m_iconset = QPixmap::fromImage(std::move(image));
+            }
+            m_compressed.clear();
+        }
 
-                    m_icons.emplace_back(std::move(pmap));
+        //! Replaces all already extracted icons, e.g. after their configuration has changed
+        void reextractIcons()
+        {
+            const auto released = m_sheetReleased;
+            const auto count    = static_cast<int>(m_slots.size());
+            for(auto index = 0; index < count; ++index)
+            {
+                const auto slot = m_slots[index];
+                if(slot >= 0 && !m_icons[slot].isNull())
+                {
+                    m_icons[slot] = extractIcon(index);
                 }
             }
+            releaseSheet(released);
+        }
+
+        /*!
+         * Releases the icon set image once all icons own their pixels and nothing else needs it
+         * \param owned True if the icons own their pixels even if not trimmed, e.g. as the image had been
+         * released before
+         */
+        void releaseSheet(const bool owned = false)
+        {
+            if(m_iconset.isNull() || (!owned && !isTrimmed()) || m_options.testFlag(SharedSheet) ||
+               m_options.testFlag(LazyExtraction) || isWatching() || m_residencyTimeout)
+            {
+                return;
+            }
+            m_iconset       = QPixmap();
+            m_sheetReleased = true;
         }
+
+        /*!
+         * Calculates the area an icon occupies within the icon set image
+         * \param index The 1D index of the icon
+         * \returns The icon area in pixels
+         */
+        QRect iconRect(const int index) const Q_DECL_NOEXCEPT
+        {
+            return iconRect(index, m_matrixSize, m_iconSize);
+        }
+
+        /*!
+         * Calculates the area an icon occupies within an icon set image
+         * \param index The 1D index of the icon
+         * \param matrixSize The icon set matrix size
+         * \param iconSize The size of each icon
+         * \returns The icon area in pixels
+         */
+        static QRect iconRect(const int index, const QPoint& matrixSize, const QPoint& iconSize) Q_DECL_NOEXCEPT
+        {
+            const auto row = index / matrixSize.x();
+            const auto col = index - (row * matrixSize.x());
+
+            return QRect(col * iconSize.x(), row * iconSize.y(), iconSize.x(), iconSize.y());
+        }
+
         /*!
          * Converts a 2D index position (column/row) into a 1D index
          * \param col The column index of the icon
@@ -269,6 +1425,8 @@ namespace qtex
             return QPoint(col, row);
         }
     };
+
+    Q_DECLARE_OPERATORS_FOR_FLAGS(QIconSet::LoadOptions)
 }    // namespace qtex
 
 
@@ -0,0 +1,206 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QICONSETCACHE_H
+#define QICONSETCACHE_H
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QHash>
+#include <list>
+#include <memory>
+
+#include "QIconSet.h"
+#include "QMetrics.h"
+
+namespace qtex
+{
+    /*!
+     * \class QIconSetCache
+     * \brief Process-wide cache handing out shared icon sets
+     *
+     * Icon sets are keyed by their resource path, matrix size, icon size and load options, so each
+     * icon set image is decoded and sliced only once per process no matter how many widgets request it.
+     *
+     * The handed out icon sets are immutable and reference counted. The cache itself only holds one
+     * reference per icon set, so evicting an icon set never invalidates it for its current users.
+     *
+     * An optional memory budget limits the resident memory of the cached icon sets. When exceeded,
+     * the least recently acquired icon sets are evicted first.
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * auto iconset = QIconSetCache::instance().acquire(":/buttons/iconset.png", QPoint(8, 4));
+     * button->setIcon(iconset->getIcon(2, 1));
+     * \endcode
+     *
+     * \remark Like QPixmap the cache must only be used from the GUI thread
+     * \remark The cache is cleared when the application object is destroyed (see qAddPostRoutine()), as pixmaps
+     * must not outlive it. Icon sets still held by their users at that point must be released before, too.
+     */
+    class QIconSetCache
+    {
+    public:
+        using SharedIconSet = std::shared_ptr<const QIconSet>;
+
+        //! The process-wide cache instance
+        static QIconSetCache& instance()
+        {
+            static QIconSetCache cache;
+            return cache;
+        }
+
+        /*!
+         * Retrieves a shared icon set, loading it if it is not cached yet
+         * \param path The resource path of the icon set, e.g. ":/buttons/iconset.png"
+         * \param colRow The (maximum) amount of icons contained in the resource image given as columns and rows
+         * \param iconSize The size of each icon given in pixels, a null size calculates it automatically
+         * \param options The options controlling the icon extraction
+         * \returns The shared icon set
+         */
+        SharedIconSet acquire(const QString& path, const QPoint& colRow, const QPoint& iconSize = QPoint(),
+                              QIconSet::LoadOptions options = QIconSet::NoLoadOption)
+        {
+            const Key key {path, colRow, iconSize, options};
+
+            const auto found = m_lookup.find(key);
+            if(found != m_lookup.end())
+            {
+                QTEX_METRIC_COUNT("qiconset.sharedcache.hit", path, 1);
+
+                // Mark as most recently used
+                m_entries.splice(m_entries.begin(), m_entries, found.value());
+                return m_entries.front().iconSet;
+            }
+
+            QTEX_METRIC_COUNT("qiconset.sharedcache.miss", path, 1);
+
+            // The static instance would only be destroyed after the application
+            if(!m_cleanup)
+            {
+                qAddPostRoutine(&QIconSetCache::cleanup);
+                m_cleanup = true;
+            }
+
+            auto iconSet = std::make_shared<const QIconSet>(path, colRow, iconSize, nullptr, options);
+            m_entries.push_front(Entry {key, iconSet});
+            m_lookup.insert(key, m_entries.begin());
+
+            trim();
+            return iconSet;
+        }
+
+        /*!
+         * Sets the memory budget of the cache
+         * \param bytes The maximum amount of bytes the cached icon sets may occupy, 0 for no limit
+         * \remark The most recently acquired icon set is always kept, even if it exceeds the budget alone
+         */
+        void setMemoryBudget(const qint64 bytes)
+        {
+            m_budget = bytes;
+            trim();
+        }
+
+        //! Retrieves the memory budget in bytes, 0 if unlimited
+        qint64 getMemoryBudget() const Q_DECL_NOEXCEPT
+        {
+            return m_budget;
+        }
+
+        //! Retrieves the approximate memory occupied by all cached icon sets in bytes
+        qint64 getMemoryUsage() const Q_DECL_NOEXCEPT
+        {
+            qint64 bytes = 0;
+            for(const auto& entry : m_entries)
+            {
+                bytes += entry.iconSet->getMemoryUsage();
+            }
+            return bytes;
+        }
+
+        //! Retrieves the amount of cached icon sets
+        int size() const Q_DECL_NOEXCEPT
+        {
+            return m_lookup.size();
+        }
+
+        //! Drops all cached icon sets. Icon sets still in use stay alive until released by their users
+        void clear()
+        {
+            m_lookup.clear();
+            m_entries.clear();
+        }
+
+    private:
+        struct Key
+        {
+            QString                 path;
+            QPoint                  colRow;
+            QPoint                  iconSize;
+            QIconSet::LoadOptions   options;
+
+            bool operator==(const Key& other) const
+            {
+                return path == other.path && colRow == other.colRow && iconSize == other.iconSize &&
+                       options == other.options;
+            }
+
+            friend uint qHash(const Key& key, uint seed = 0)
+            {
+                return qHash(key.path, seed) ^ qHash((key.colRow.x() << 16) ^ key.colRow.y(), seed) ^
+                       qHash((key.iconSize.x() << 16) ^ key.iconSize.y(), seed) ^
+                       qHash(static_cast<int>(key.options), seed);
+            }
+        };
+
+        struct Entry
+        {
+            Key             key;
+            SharedIconSet   iconSet;
+        };
+
+        using Entries = std::list<Entry>;
+
+        Entries                             m_entries;      //<! Cached icon sets, most recently used first
+        QHash<Key, Entries::iterator>       m_lookup;       //<! Key to entry look-up
+        qint64                              m_budget = 0;   //<! The memory budget in bytes, 0 if unlimited
+        bool                                m_cleanup = false; //<! True if cleanup() is registered
+
+        QIconSetCache() = default;
+        Q_DISABLE_COPY(QIconSetCache)
+
+        //! Clears the instance on destruction of the application, registered once an icon set is cached
+        static void cleanup()
+        {
+            auto& cache = instance();
+            cache.clear();
+            cache.m_cleanup = false;
+        }
+
+        //! Evicts the least recently used icon sets until the budget is met
+        void trim()
+        {
+            if(m_budget <= 0)
+            {
+                return;
+            }
+
+            auto usage = getMemoryUsage();
+            while(usage > m_budget && m_entries.size() > 1)
+            {
+                const auto& last = m_entries.back();
+                usage -= last.iconSet->getMemoryUsage();
+
+                m_lookup.remove(last.key);
+                m_entries.pop_back();
+            }
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QICONSETCACHE_H
@@ -0,0 +1,249 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QICONSETCACHEFILE_H
+#define QICONSETCACHEFILE_H
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtGui/QImage>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace qtex
+{
+    /*!
+     * \class QIconSetCacheFile
+     * \brief Reads and writes fully sliced icon sets as binary cache files
+     *
+     * A cache file stores an icon set in a form which can be used without decoding the icon set image:
+     * - a fixed size header holding the matrix size, the icon size and the fingerprint (size and MD5 hash)
+     *   of the source image file
+     * - a tile occupancy bitmap with one bit per icon, cleared bits mark empty icon areas
+     * - the raw premultiplied ARGB32 pixels of each populated icon, tightly packed
+     *
+     * Reading memory-maps the file and wraps each icon with QImage's external buffer constructor,
+     * so no pixel data is copied until an icon is actually turned into a pixmap.
+     *
+     * A cache file is stale as soon as the source image file changes in size or content. Since the
+     * pixel data is stored in native byte order a file written on a machine of different endianness
+     * is treated as stale as well, so cache files are safe to ship or to build on first run.
+     */
+    class QIconSetCacheFile
+    {
+    public:
+        //! The content of a cache file
+        struct Content
+        {
+            QPoint                  matrixSize;         //<! The icon set matrix size
+            QPoint                  iconSize;           //<! The size of each icon
+            bool                    skipEmpty = false;  //<! True if empty icon areas have been skipped
+            std::vector<int>        slotMap;            //<! Maps a 1D index to its tile, -1 for empty areas
+            int                     populated = 0;      //<! The amount of populated icons
+            std::vector<QImage>     tiles;              //<! The populated icons, referencing the mapped file
+            std::shared_ptr<QFile>  mapping;            //<! Keeps the file mapped as long as the tiles are in use
+        };
+
+        /*!
+         * Writes a cache file
+         * \param cacheFile The path of the cache file
+         * \param sourcePath The path of the icon set image the icon set has been loaded from
+         * \param content The icon set layout, the tiles are ignored
+         * \param tile Provides the image of a populated icon given its 1D index
+         * \returns True on success
+         */
+        static bool write(const QString& cacheFile, const QString& sourcePath, const Content& content,
+                          const std::function<QImage(int)>& tile)
+        {
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            header.magic        = Magic;
+            header.version      = Version;
+            header.matrixSize[0]= content.matrixSize.x();
+            header.matrixSize[1]= content.matrixSize.y();
+            header.iconSize[0]  = content.iconSize.x();
+            header.iconSize[1]  = content.iconSize.y();
+            header.skipEmpty    = content.skipEmpty ? 1 : 0;
+            header.populated    = content.populated;
+            if(!fingerprint(sourcePath, header.sourceSize, header.sourceHash))
+            {
+                return false;
+            }
+
+            const auto count = static_cast<int>(content.slotMap.size());
+            QByteArray occupancy((count + 7) / 8, '\0');
+            for(auto index = 0; index < count; ++index)
+            {
+                if(content.slotMap[index] >= 0)
+                {
+                    occupancy[index / 8] = static_cast<char>(occupancy[index / 8] | (1 << (index % 8)));
+                }
+            }
+            header.dataOffset = align(sizeof(Header) + occupancy.size());
+
+            QSaveFile file(cacheFile);
+            if(!file.open(QIODevice::WriteOnly))
+            {
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(occupancy);
+            file.write(QByteArray(static_cast<int>(header.dataOffset - sizeof(Header) - occupancy.size()), '\0'));
+
+            const auto lineBytes = content.iconSize.x() * 4;
+            for(auto index = 0; index < count; ++index)
+            {
+                if(content.slotMap[index] < 0)
+                {
+                    continue;
+                }
+
+                const auto image = tile(index).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+                if(image.width() != content.iconSize.x() || image.height() != content.iconSize.y())
+                {
+                    file.cancelWriting();
+                    return false;
+                }
+                for(auto y = 0; y < image.height(); ++y)
+                {
+                    file.write(reinterpret_cast<const char*>(image.constScanLine(y)), lineBytes);
+                }
+            }
+            return file.commit();
+        }
+
+        /*!
+         * Reads a cache file
+         * \param cacheFile The path of the cache file
+         * \param sourcePath The path of the icon set image the cache file must have been created from
+         * \param content Receives the content
+         * \returns False if the cache file does not exist, is stale or corrupt
+         */
+        static bool read(const QString& cacheFile, const QString& sourcePath, Content& content)
+        {
+            auto file = std::make_shared<QFile>(cacheFile);
+            if(!file->open(QIODevice::ReadOnly) || file->size() < static_cast<qint64>(sizeof(Header)))
+            {
+                return false;
+            }
+
+            const auto* data = file->map(0, file->size());
+            if(!data)
+            {
+                return false;
+            }
+
+            Header header;
+            std::memcpy(&header, data, sizeof(header));
+            if(header.magic != Magic || header.version != Version)
+            {
+                return false;
+            }
+
+            qint64 sourceSize = 0;
+            char   sourceHash[16];
+            if(!fingerprint(sourcePath, sourceSize, sourceHash) || sourceSize != header.sourceSize ||
+               std::memcmp(sourceHash, header.sourceHash, sizeof(sourceHash)) != 0)
+            {
+                return false;
+            }
+
+            const auto count     = header.matrixSize[0] * header.matrixSize[1];
+            const auto tileBytes = static_cast<qint64>(header.iconSize[0]) * header.iconSize[1] * 4;
+            if(count <= 0 || tileBytes <= 0 ||
+               header.dataOffset < static_cast<qint64>(sizeof(Header)) + (count + 7) / 8 ||
+               header.dataOffset + header.populated * tileBytes > file->size())
+            {
+                return false;
+            }
+
+            content.matrixSize  = QPoint(header.matrixSize[0], header.matrixSize[1]);
+            content.iconSize    = QPoint(header.iconSize[0], header.iconSize[1]);
+            content.skipEmpty   = header.skipEmpty != 0;
+            content.populated   = 0;
+            content.slotMap.clear();
+            content.slotMap.reserve(count);
+            content.tiles.clear();
+            content.tiles.reserve(header.populated);
+
+            const auto* occupancy = data + sizeof(Header);
+            for(auto index = 0; index < count; ++index)
+            {
+                if(!(occupancy[index / 8] & (1 << (index % 8))))
+                {
+                    content.slotMap.push_back(-1);
+                    continue;
+                }
+                if(content.populated >= header.populated)
+                {
+                    return false;
+                }
+
+                const auto* pixels = data + header.dataOffset + content.populated * tileBytes;
+                content.tiles.emplace_back(pixels, content.iconSize.x(), content.iconSize.y(),
+                                           content.iconSize.x() * 4, QImage::Format_ARGB32_Premultiplied);
+                content.slotMap.push_back(content.populated++);
+            }
+
+            content.mapping = std::move(file);
+            return content.populated == header.populated;
+        }
+
+    private:
+        static const quint32 Magic   = 0x53434951;  //<! "QICS" in little endian
+        static const quint32 Version = 1;
+
+        //! The fixed size file header, naturally aligned so it can be copied straight out of the mapping
+        struct Header
+        {
+            quint32 magic;
+            quint32 version;
+            qint32  matrixSize[2];
+            qint32  iconSize[2];
+            qint32  skipEmpty;
+            qint32  populated;
+            qint64  sourceSize;
+            char    sourceHash[16];
+            qint64  dataOffset;
+        };
+
+        //! Aligns the tile data, so every scanline is suitably aligned for QImage
+        static qint64 align(const qint64 offset) Q_DECL_NOEXCEPT
+        {
+            return (offset + 15) & ~qint64(15);
+        }
+
+        //! Calculates the size and MD5 hash of a file
+        static bool fingerprint(const QString& path, qint64& size, char (&hash)[16])
+        {
+            QFile file(path);
+            if(!file.open(QIODevice::ReadOnly))
+            {
+                return false;
+            }
+
+            QCryptographicHash md5(QCryptographicHash::Md5);
+            if(!md5.addData(&file))
+            {
+                return false;
+            }
+
+            const auto result = md5.result();
+            std::memcpy(hash, result.constData(), sizeof(hash));
+            size = file.size();
+            return true;
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QICONSETCACHEFILE_H
@@ -0,0 +1,497 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QICONSETENGINE_H
+#define QICONSETENGINE_H
+
+#include <QtCore/QStringBuilder>
+#include <QtGui/QIconEngine>
+#include <QtGui/QPainter>
+#include <QtGui/QPixmap>
+#include <QtGui/QPixmapCache>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "QIconEffect.h"
+
+namespace qtex
+{
+    /*!
+     * \class QIconSetResolutions
+     * \brief Additional high resolution variants of an icon set image
+     *
+     * Each variant is the same icon set layout at a higher device pixel ratio (e.g. an "@2x" image with
+     * icons of twice the size). A variant is only decoded once an icon is actually requested at a
+     * pixel size which the lower resolutions can't satisfy, e.g. by a painter on a high-DPI screen.
+     *
+     * The variants are shared by all icons of an icon set.
+     */
+    class QIconSetResolutions
+    {
+    public:
+        /*!
+         * Constructs an empty set of variants
+         * \param matrixSize The icon set matrix size all variants share
+         */
+        explicit QIconSetResolutions(const QPoint& matrixSize)
+            : m_matrixSize  (matrixSize)
+        {
+        }
+
+        /*!
+         * Adds a high resolution variant
+         * \param path The resource path of the variant, e.g. ":/buttons/iconset@2x.png"
+         * \param devicePixelRatio The device pixel ratio the variant is designed for, e.g. 2.0
+         */
+        void add(const QString& path, const qreal devicePixelRatio)
+        {
+            const auto pos = std::find_if(m_variants.begin(), m_variants.end(), [devicePixelRatio](const Variant& v)
+            {
+                return v.devicePixelRatio >= devicePixelRatio;
+            });
+            m_variants.insert(pos, Variant {path, devicePixelRatio, QPixmap(), false});
+        }
+
+        /*!
+         * Selects the variant best matching a requested pixel size
+         * \param pixelSize The requested size in device pixels
+         * \param baseSize The size of the icon at the base resolution
+         * \returns The variant index or -1 if the base resolution is sufficient
+         */
+        int select(const QSize& pixelSize, const QSize& baseSize) const
+        {
+            if(m_variants.empty() || baseSize.isEmpty())
+            {
+                return -1;
+            }
+
+            const auto scale = qMax(static_cast<qreal>(pixelSize.width()) / baseSize.width(),
+                                    static_cast<qreal>(pixelSize.height()) / baseSize.height());
+            if(scale <= 1.0)
+            {
+                return -1;
+            }
+
+            // The smallest variant that is big enough, otherwise the biggest one
+            const auto count = static_cast<int>(m_variants.size());
+            for(auto variant = 0; variant < count; ++variant)
+            {
+                if(m_variants[variant].devicePixelRatio + 0.01 >= scale)
+                {
+                    return variant;
+                }
+            }
+            return count - 1;
+        }
+
+        //! Retrieves the device pixel ratio of a variant
+        qreal getDevicePixelRatio(const int variant) const
+        {
+            return m_variants[variant].devicePixelRatio;
+        }
+
+        /*!
+         * Retrieves the image of a variant, decoding it on first use
+         * \param variant The variant index
+         * \returns The image, null if it failed to load
+         */
+        const QPixmap& getSheet(const int variant)
+        {
+            auto& v = m_variants[variant];
+            if(!v.decoded)
+            {
+                v.sheet   = QPixmap(v.path);
+                v.decoded = true;
+            }
+            return v.sheet;
+        }
+
+        /*!
+         * Calculates the area an icon occupies within the image of a variant
+         * \param variant The variant index
+         * \param index The 1D index of the icon
+         * \returns The icon area in pixels
+         */
+        QRect getIconRect(const int variant, const int index)
+        {
+            const auto& sheet = getSheet(variant);
+            const auto  w     = sheet.width() / m_matrixSize.x();
+            const auto  h     = sheet.height() / m_matrixSize.y();
+            const auto  row   = index / m_matrixSize.x();
+            const auto  col   = index - (row * m_matrixSize.x());
+
+            return QRect(col * w, row * h, w, h);
+        }
+
+        //! Retrieves the approximate memory occupied by all decoded variants in bytes
+        qint64 getMemoryUsage() const Q_DECL_NOEXCEPT
+        {
+            qint64 bytes = 0;
+            for(const auto& v : m_variants)
+            {
+                bytes += static_cast<qint64>(v.sheet.width()) * v.sheet.height() * (v.sheet.depth() / 8);
+            }
+            return bytes;
+        }
+
+        //! Retrieves the amount of variants
+        int size() const Q_DECL_NOEXCEPT
+        {
+            return static_cast<int>(m_variants.size());
+        }
+
+    private:
+        struct Variant
+        {
+            QString path;               //<! The resource path of the variant
+            qreal   devicePixelRatio;   //<! The device pixel ratio the variant is designed for
+            QPixmap sheet;              //<! The decoded image
+            bool    decoded;            //<! True once decoding has been attempted
+        };
+
+        QPoint                  m_matrixSize;   //<! The icon set matrix size
+        std::vector<Variant>    m_variants;     //<! All variants, sorted by device pixel ratio
+    };
+
+    /*!
+     * \class QIconSetEngine
+     * \brief Icon engine that paints a sub-rectangle of a shared icon set image
+     *
+     * Instead of holding an own copy of the icon pixels the engine only keeps an (implicitly shared)
+     * reference to the icon set image plus the source rectangle of the icon within it.
+     * Painting directly blits the source rectangle, so no per icon pixel data is ever allocated.
+     *
+     * Requests for a standalone pixmap (e.g. by widgets calling QIcon::pixmap()) are served from
+     * the global QPixmapCache, so the pixel copy only lives as long as the cache sees fit.
+     *
+     * If the icon set has high resolution variants (see QIconSetResolutions), requests exceeding the
+     * base resolution, e.g. by a painter on a high-DPI screen, are served from the best matching variant.
+     *
+     * Icon modes with an effect (see QIconEffect) are generated once per icon and mode on their first request
+     * and kept by the engine, so repainting e.g. disabled icons never re-processes their pixels.
+     */
+    class QIconSetEngine : public QIconEngine
+    {
+    public:
+        /*!
+         * Constructs the engine
+         * \param sheet The icon set image the icon is contained in
+         * \param source The rectangle of the icon within the icon set image
+         * \param resolutions The optional high resolution variants of the icon set image
+         * \param index The 1D index of the icon within the icon set, used to look up the variants
+         * \param effects The optional effects generating the icon modes
+         */
+        QIconSetEngine(const QPixmap& sheet, const QRect& source,
+                       std::shared_ptr<QIconSetResolutions> resolutions = nullptr, const int index = 0,
+                       std::shared_ptr<const QIconEffects> effects = nullptr)
+            : m_sheet       (sheet)
+            , m_source      (source)
+            , m_resolutions (std::move(resolutions))
+            , m_index       (index)
+            , m_effects     (std::move(effects))
+        {
+        }
+
+        void paint(QPainter* painter, const QRect& rect, QIcon::Mode mode, QIcon::State state) Q_DECL_OVERRIDE
+        {
+            const auto  dpr  = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+            const auto  area = select(rect.size() * dpr);
+
+            if(getEffect(mode))
+            {
+                painter->drawPixmap(rect, pixmap(rect.size() * dpr, mode, state));
+                return;
+            }
+            painter->drawPixmap(rect, *area.sheet, area.source);
+        }
+
+        QSize actualSize(const QSize& size, QIcon::Mode mode, QIcon::State state) Q_DECL_OVERRIDE
+        {
+            Q_UNUSED(mode);
+            Q_UNUSED(state);
+
+            auto actual = select(size).source.size();
+            if(actual.width() > size.width() || actual.height() > size.height())
+            {
+                actual = actual.scaled(size, Qt::KeepAspectRatio);
+            }
+            return actual;
+        }
+
+        QPixmap pixmap(const QSize& size, QIcon::Mode mode, QIcon::State state) Q_DECL_OVERRIDE
+        {
+            const auto  area   = select(size);
+            const auto  actual = actualSize(size, mode, state);
+            const auto* effect = getEffect(mode);
+            if(effect && actual == area.source.size())
+            {
+                return modePixmap(area, mode, *effect);
+            }
+
+            const QString key = QLatin1String("qtex_iconset_") % QString::number(area.sheet->cacheKey())
+                              % QLatin1Char('_') % QString::number(area.source.x())
+                              % QLatin1Char('_') % QString::number(area.source.y())
+                              % QLatin1Char('_') % QString::number(actual.width())
+                              % QLatin1Char('_') % QString::number(actual.height())
+                              % QLatin1Char('_') % QString::number(effect ? mode : QIcon::Normal);
+
+            QPixmap pmap;
+            if(!QPixmapCache::find(key, &pmap))
+            {
+                pmap = effect ? modePixmap(area, mode, *effect) : area.sheet->copy(area.source);
+                if(pmap.size() != actual)
+                {
+                    pmap = pmap.scaled(actual, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+                }
+                pmap.setDevicePixelRatio(area.devicePixelRatio);
+                QPixmapCache::insert(key, pmap);
+            }
+            return pmap;
+        }
+
+        QList<QSize> availableSizes(QIcon::Mode mode, QIcon::State state) const Q_DECL_OVERRIDE
+        {
+            Q_UNUSED(mode);
+            Q_UNUSED(state);
+
+            QList<QSize> sizes;
+            sizes << m_source.size();
+            for(auto variant = 0; m_resolutions && variant < m_resolutions->size(); ++variant)
+            {
+                sizes << m_source.size() * m_resolutions->getDevicePixelRatio(variant);
+            }
+            return sizes;
+        }
+
+        QString key() const Q_DECL_OVERRIDE
+        {
+            return QStringLiteral("QIconSetEngine");
+        }
+
+        QIconEngine* clone() const Q_DECL_OVERRIDE
+        {
+            return new QIconSetEngine(*this);
+        }
+
+    private:
+        //! An icon area within one of the available icon set images
+        struct Area
+        {
+            const QPixmap*  sheet;
+            QRect           source;
+            qreal           devicePixelRatio;
+        };
+
+        QPixmap                                 m_sheet;        //<! The shared icon set image
+        QRect                                   m_source;       //<! The icon area within the icon set image
+        std::shared_ptr<QIconSetResolutions>    m_resolutions;  //<! The optional high resolution variants
+        int                                     m_index;        //<! The 1D index of the icon within the icon set
+        std::shared_ptr<const QIconEffects>     m_effects;      //<! The optional effects generating the icon modes
+        std::array<QPixmap, 4>                  m_modes;        //<! The generated icon modes at their source size
+
+        /*!
+         * Retrieves the effect of an icon mode, null if the mode isn't generated by an effect.
+         * Without an effect QIcon::Disabled falls back to QIconEffect::disabled(), since Qt leaves
+         * generating disabled icons to custom engines.
+         */
+        const QIconEffect* getEffect(const QIcon::Mode mode) const
+        {
+            if(mode == QIcon::Normal)
+            {
+                return nullptr;
+            }
+            if(m_effects && !(*m_effects)[mode].isNull())
+            {
+                return &(*m_effects)[mode];
+            }
+            return mode == QIcon::Disabled ? &QIconEffect::disabled() : nullptr;
+        }
+
+        /*!
+         * Retrieves an icon mode, generating it on first request
+         * \param area The icon area to generate the mode out of
+         * \param mode The icon mode
+         * \param effect The effect generating the icon mode
+         * \returns The icon mode pixmap at the size of the icon area
+         */
+        QPixmap modePixmap(const Area& area, const QIcon::Mode mode, const QIconEffect& effect)
+        {
+            // Regenerate if e.g. a different resolution variant is requested
+            auto& pmap = m_modes[mode];
+            if(pmap.isNull() || pmap.size() != area.source.size())
+            {
+                pmap = effect.apply(area.sheet->copy(area.source));
+                pmap.setDevicePixelRatio(area.devicePixelRatio);
+            }
+            return pmap;
+        }
+
+        /*!
+         * Selects the icon area best matching a requested pixel size
+         * \param pixelSize The requested size in device pixels
+         * \returns The base resolution area or the area within the best matching high resolution variant
+         */
+        Area select(const QSize& pixelSize)
+        {
+            const auto variant = m_resolutions ? m_resolutions->select(pixelSize, m_source.size()) : -1;
+            if(variant >= 0)
+            {
+                const auto& sheet = m_resolutions->getSheet(variant);
+                if(!sheet.isNull())
+                {
+                    return Area {&sheet, m_resolutions->getIconRect(variant, m_index),
+                                 m_resolutions->getDevicePixelRatio(variant)};
+                }
+            }
+            return Area {&m_sheet, m_source, 1.0};
+        }
+    };
+
+    /*!
+     * \class QTrimmedIconEngine
+     * \brief Icon engine that paints the opaque part of an icon at its offset within the icon cell
+     *
+     * Icons placed in the middle of large, mostly transparent cells only keep the pixels of their opaque
+     * bounding box. Painting blits just that sub-pixmap at its (scaled) offset within the target rectangle,
+     * so both memory and blit bandwidth scale with the visible pixels rather than with the cell size.
+     *
+     * Requests for a standalone pixmap are composed at the full cell size and served from the global
+     * QPixmapCache, like QIconSetEngine does.
+     */
+    class QTrimmedIconEngine : public QIconEngine
+    {
+    public:
+        /*!
+         * Constructs the engine
+         * \param pixmap The opaque part of the icon, null if the icon is fully transparent
+         * \param offset The position of the opaque part within the icon cell
+         * \param size The size of the icon cell
+         * \param effects The optional effects generating the icon modes
+         */
+        QTrimmedIconEngine(const QPixmap& pixmap, const QPoint& offset, const QSize& size,
+                           std::shared_ptr<const QIconEffects> effects = nullptr)
+            : m_pixmap  (pixmap)
+            , m_offset  (offset)
+            , m_size    (size)
+            , m_effects (std::move(effects))
+        {
+        }
+
+        void paint(QPainter* painter, const QRect& rect, QIcon::Mode mode, QIcon::State state) Q_DECL_OVERRIDE
+        {
+            Q_UNUSED(state);
+
+            if(m_pixmap.isNull() || m_size.isEmpty())
+            {
+                return;
+            }
+
+            const auto  sx     = static_cast<qreal>(rect.width()) / m_size.width();
+            const auto  sy     = static_cast<qreal>(rect.height()) / m_size.height();
+            const QRectF target(rect.x() + m_offset.x() * sx, rect.y() + m_offset.y() * sy,
+                                m_pixmap.width() * sx, m_pixmap.height() * sy);
+
+            const auto* effect = getEffect(mode);
+            painter->drawPixmap(target, effect ? modePixmap(mode, *effect) : m_pixmap, QRectF(m_pixmap.rect()));
+        }
+
+        QSize actualSize(const QSize& size, QIcon::Mode mode, QIcon::State state) Q_DECL_OVERRIDE
+        {
+            Q_UNUSED(mode);
+            Q_UNUSED(state);
+
+            auto actual = m_size;
+            if(actual.width() > size.width() || actual.height() > size.height())
+            {
+                actual = actual.scaled(size, Qt::KeepAspectRatio);
+            }
+            return actual;
+        }
+
+        QPixmap pixmap(const QSize& size, QIcon::Mode mode, QIcon::State state) Q_DECL_OVERRIDE
+        {
+            const auto actual = actualSize(size, mode, state);
+            const QString key = QLatin1String("qtex_trimmed_") % QString::number(m_pixmap.cacheKey())
+                              % QLatin1Char('_') % QString::number(actual.width())
+                              % QLatin1Char('_') % QString::number(actual.height())
+                              % QLatin1Char('_') % QString::number(getEffect(mode) ? mode : QIcon::Normal);
+
+            QPixmap pmap;
+            if(!QPixmapCache::find(key, &pmap))
+            {
+                pmap = QPixmap(actual);
+                pmap.fill(Qt::transparent);
+
+                QPainter painter(&pmap);
+                paint(&painter, pmap.rect(), mode, state);
+                painter.end();
+
+                QPixmapCache::insert(key, pmap);
+            }
+            return pmap;
+        }
+
+        QList<QSize> availableSizes(QIcon::Mode mode, QIcon::State state) const Q_DECL_OVERRIDE
+        {
+            Q_UNUSED(mode);
+            Q_UNUSED(state);
+
+            return QList<QSize>() << m_size;
+        }
+
+        QString key() const Q_DECL_OVERRIDE
+        {
+            return QStringLiteral("QTrimmedIconEngine");
+        }
+
+        QIconEngine* clone() const Q_DECL_OVERRIDE
+        {
+            return new QTrimmedIconEngine(*this);
+        }
+
+    private:
+        QPixmap                                 m_pixmap;   //<! The opaque part of the icon
+        QPoint                                  m_offset;   //<! The position of m_pixmap within the icon cell
+        QSize                                   m_size;     //<! The size of the icon cell
+        std::shared_ptr<const QIconEffects>     m_effects;  //<! The optional effects generating the icon modes
+        std::array<QPixmap, 4>                  m_modes;    //<! The generated icon modes of m_pixmap
+
+        /*!
+         * Retrieves the effect of an icon mode, null if the mode isn't generated by an effect.
+         * Without an effect QIcon::Disabled falls back to QIconEffect::disabled(), since Qt leaves
+         * generating disabled icons to custom engines.
+         */
+        const QIconEffect* getEffect(const QIcon::Mode mode) const
+        {
+            if(mode == QIcon::Normal)
+            {
+                return nullptr;
+            }
+            if(m_effects && !(*m_effects)[mode].isNull())
+            {
+                return &(*m_effects)[mode];
+            }
+            return mode == QIcon::Disabled ? &QIconEffect::disabled() : nullptr;
+        }
+
+        //! Retrieves an icon mode of the opaque part, generating it on first request
+        const QPixmap& modePixmap(const QIcon::Mode mode, const QIconEffect& effect)
+        {
+            auto& pmap = m_modes[mode];
+            if(pmap.isNull())
+            {
+                pmap = effect.apply(m_pixmap);
+            }
+            return pmap;
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QICONSETENGINE_H
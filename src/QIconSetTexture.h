@@ -0,0 +1,119 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QICONSETTEXTURE_H
+#define QICONSETTEXTURE_H
+
+#include <QtCore/QRectF>
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+#ifndef QT_NO_OPENGL
+#include <QtGui/QOpenGLTexture>
+#endif
+#ifdef QT_QUICK_LIB
+#include <QtQuick/QQuickWindow>
+#include <QtQuick/QSGTexture>
+#endif
+
+#include "QIconSet.h"
+
+namespace qtex
+{
+    /*!
+     * \class QIconSetTexture
+     * \brief Exports an icon set image as a single GPU texture
+     *
+     * Instead of uploading each icon as its own pixmap, the whole icon set image is uploaded once and the
+     * icons are addressed by their normalized texture coordinates. So any amount of icons can be drawn
+     * with a single (instanced) draw call out of one texture.
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * // With a current OpenGL context, e.g. in QOpenGLWidget::initializeGL()
+     * m_texture.reset(QIconSetTexture::createOpenGLTexture(*iconSet));
+     * m_uvRects = QIconSetTexture::getTextureRects(*iconSet);   // per-instance attribute data
+     * \endcode
+     *
+     * The OpenGL export is available unless Qt has been built without OpenGL support, the QtQuick export
+     * if the including target links Qt Quick (QT_QUICK_LIB).
+     */
+    class QIconSetTexture
+    {
+    public:
+        /*!
+         * Calculates the normalized texture coordinates of all icons, see QIconSet::getTextureRect()
+         * \param iconSet The icon set
+         * \returns The area of each icon by its 1D index, null rectangles for invalid icons
+         */
+        static QVector<QRectF> getTextureRects(const QIconSet& iconSet)
+        {
+            const auto count = iconSet.getMatrixSize().x() * iconSet.getMatrixSize().y();
+
+            QVector<QRectF> rects;
+            rects.reserve(count);
+            for(auto index = 0; index < count; ++index)
+            {
+                rects.append(iconSet.getTextureRect(index));
+            }
+            return rects;
+        }
+
+#ifndef QT_NO_OPENGL
+        /*!
+         * Uploads the icon set image as an OpenGL texture, requires a current OpenGL context
+         * \param iconSet The icon set
+         * \param mipmaps True to generate mipmaps, e.g. for icons drawn scaled down
+         * \returns The texture owned by the caller, null if the icon set doesn't keep its image
+         * (see QIconSet::getSheetImage())
+         */
+        static QOpenGLTexture* createOpenGLTexture(const QIconSet& iconSet, const bool mipmaps = false)
+        {
+            const auto image = iconSet.getSheetImage();
+            if(image.isNull())
+            {
+                return nullptr;
+            }
+
+            auto* texture = new QOpenGLTexture(image, mipmaps ? QOpenGLTexture::GenerateMipMaps
+                                                              : QOpenGLTexture::DontGenerateMipMaps);
+            texture->setMinMagFilters(mipmaps ? QOpenGLTexture::LinearMipMapLinear : QOpenGLTexture::Linear,
+                                      QOpenGLTexture::Linear);
+            // Neighboring icons must not bleed in at the icon borders
+            texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+            return texture;
+        }
+#endif
+
+#ifdef QT_QUICK_LIB
+        /*!
+         * Uploads the icon set image as a scene graph texture, e.g. in QQuickItem::updatePaintNode()
+         * \param iconSet The icon set
+         * \param window The window the texture is used in
+         * \returns The texture owned by the caller, null if the icon set doesn't keep its image
+         * (see QIconSet::getSheetImage())
+         * \remark The texture is never placed in the scene graph's atlas, so the icon texture coordinates
+         * apply as they are
+         */
+        static QSGTexture* createSGTexture(const QIconSet& iconSet, const QQuickWindow* window)
+        {
+            const auto image = iconSet.getSheetImage();
+            if(image.isNull() || !window)
+            {
+                return nullptr;
+            }
+
+            auto* texture = window->createTextureFromImage(image, QQuickWindow::TextureHasAlphaChannel);
+            texture->setFiltering(QSGTexture::Linear);
+            return texture;
+        }
+#endif
+    };
+}    // namespace qtex
+
+
+#endif    // QICONSETTEXTURE_H
@@ -0,0 +1,187 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QMETRICS_H
+#define QMETRICS_H
+
+/*!
+ * Instrumentation of the qtex tools, compiled in only if QTEX_ENABLE_METRICS is defined.
+ * Otherwise the QTEX_METRIC_* macros expand to nothing and their arguments are not evaluated.
+ *
+ * Recorded metrics, the scope is the icon set path or the settings group:
+ * - qiconset.decode            time    decoding and slicing the icon set image
+ * - qiconset.tiles             count   populated icons of a loaded icon set
+ * - qiconset.bytes             gauge   pixel data resident after loading an icon set
+ * - qiconset.cachefile.hit     count   cache file hits of QIconSet::loadCached()
+ * - qiconset.cachefile.miss    count   cache file misses of QIconSet::loadCached()
+ * - qiconset.sharedcache.hit   count   QIconSetCache hits
+ * - qiconset.sharedcache.miss  count   QIconSetCache misses
+ * - qsettings.read             time    reading a group from QSettings
+ * - qsettings.write            time    writing a group to QSettings
+ * - qsettings.keysRead         count   keys read from QSettings
+ * - qsettings.keysWritten      count   (dirty) keys written to QSettings
+ * - qsettings.conversionFailures count values not convertible to the requested type
+ */
+#ifdef QTEX_ENABLE_METRICS
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+#include <atomic>
+
+namespace qtex
+{
+    /*!
+     * \class QMetricsSink
+     * \brief Receives the metrics recorded by the qtex tools
+     *
+     * The methods may be called from any thread (e.g. icon set decoding in loadAsync()),
+     * so implementations must be thread-safe.
+     */
+    class QMetricsSink
+    {
+    public:
+        virtual ~QMetricsSink() = default;
+
+        //! A counter increased by value
+        virtual void count(const char* metric, const QString& scope, qint64 value) = 0;
+
+        //! A current value, e.g. an amount of bytes
+        virtual void gauge(const char* metric, const QString& scope, qint64 value) = 0;
+
+        //! A duration in nanoseconds
+        virtual void time(const char* metric, const QString& scope, qint64 nsecs) = 0;
+    };
+
+    /*!
+     * \class QLoggingMetricsSink
+     * \brief Traces all metrics as debug messages of the "qtex.metrics" logging category
+     */
+    class QLoggingMetricsSink : public QMetricsSink
+    {
+    public:
+        void count(const char* metric, const QString& scope, const qint64 value) override
+        {
+            qCDebug(category) << metric << scope << "count" << value;
+        }
+
+        void gauge(const char* metric, const QString& scope, const qint64 value) override
+        {
+            qCDebug(category) << metric << scope << "gauge" << value;
+        }
+
+        void time(const char* metric, const QString& scope, const qint64 nsecs) override
+        {
+            qCDebug(category) << metric << scope << "time" << nsecs << "ns";
+        }
+
+        static const QLoggingCategory& category()
+        {
+            static const QLoggingCategory category("qtex.metrics");
+            return category;
+        }
+    };
+
+    /*!
+     * \class QMetrics
+     * \brief Dispatches the recorded metrics to the installed sink
+     *
+     * \code {.cpp}
+     * static QLoggingMetricsSink sink;
+     * QMetrics::setSink(&sink);
+     * \endcode
+     */
+    class QMetrics
+    {
+    public:
+        //! Installs a sink, nullptr to drop all metrics. The sink must outlive its installation.
+        static void setSink(QMetricsSink* sink) Q_DECL_NOEXCEPT
+        {
+            instance().store(sink);
+        }
+
+        static QMetricsSink* getSink() Q_DECL_NOEXCEPT
+        {
+            return instance().load();
+        }
+
+        static void count(const char* metric, const QString& scope, const qint64 value)
+        {
+            if(auto* sink = getSink())
+            {
+                sink->count(metric, scope, value);
+            }
+        }
+
+        static void gauge(const char* metric, const QString& scope, const qint64 value)
+        {
+            if(auto* sink = getSink())
+            {
+                sink->gauge(metric, scope, value);
+            }
+        }
+
+        static void time(const char* metric, const QString& scope, const qint64 nsecs)
+        {
+            if(auto* sink = getSink())
+            {
+                sink->time(metric, scope, nsecs);
+            }
+        }
+
+        //! Records the time from its construction to its destruction
+        class ScopedTimer
+        {
+        public:
+            ScopedTimer(const char* metric, const QString& scope)
+                : m_metric  (metric)
+                , m_scope   (scope)
+            {
+                m_timer.start();
+            }
+
+            ~ScopedTimer()
+            {
+                QMetrics::time(m_metric, m_scope, m_timer.nsecsElapsed());
+            }
+
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        private:
+            const char*     m_metric;
+            const QString&  m_scope;    //<! Must outlive the timer
+            QElapsedTimer   m_timer;
+        };
+
+    private:
+        static std::atomic<QMetricsSink*>& instance() Q_DECL_NOEXCEPT
+        {
+            static std::atomic<QMetricsSink*> sink(nullptr);
+            return sink;
+        }
+    };
+}    // namespace qtex
+
+#define QTEX_METRIC_COUNT(metric, scope, value) ::qtex::QMetrics::count(metric, scope, value)
+#define QTEX_METRIC_GAUGE(metric, scope, value) ::qtex::QMetrics::gauge(metric, scope, value)
+#define QTEX_METRIC_CONCAT_(a, b) a##b
+#define QTEX_METRIC_CONCAT(a, b) QTEX_METRIC_CONCAT_(a, b)
+#define QTEX_METRIC_SCOPED_TIMER(metric, scope) \
+    const ::qtex::QMetrics::ScopedTimer QTEX_METRIC_CONCAT(qtexMetricTimer, __LINE__)(metric, scope)
+
+#else
+
+#define QTEX_METRIC_COUNT(metric, scope, value) do {} while(false)
+#define QTEX_METRIC_GAUGE(metric, scope, value) do {} while(false)
+#define QTEX_METRIC_SCOPED_TIMER(metric, scope) do {} while(false)
+
+#endif    // QTEX_ENABLE_METRICS
+
+
+#endif    // QMETRICS_H
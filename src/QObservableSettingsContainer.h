@@ -0,0 +1,250 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QOBSERVABLESETTINGSCONTAINER_H
+#define QOBSERVABLESETTINGSCONTAINER_H
+
+#include <QtCore/QSettings>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "QSettingsContainer.h"
+
+namespace qtex
+{
+    /*!
+     * \class QObservableSettingsContainer
+     * \brief QSettingsContainer which notifies about value changes
+     *
+     * Callbacks are registered per key (or for all keys) and are only called when a value actually
+     * changes, either by setValue() or by read(). Setting a value equal to the stored one is silent.
+     *
+     * Additionally the container counts versions. The global version increases with every change and
+     * each key remembers the global version of its last change. So consumers of derived state can cheaply
+     * check whether anything they depend on changed since they computed it, without any callback.
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * QObservableSettingsContainer<int> proceduralData("DataGroupName");
+     *
+     * const auto id = proceduralData.observe(DataA, [checkbox](int, const QVariant& value)
+     * {
+     *     checkbox->setChecked(value.toBool());
+     * });
+     * ...
+     * proceduralData.unobserve(id);
+     * \endcode
+     * \code {.cpp}
+     * if(proceduralData.getVersion(DataB) != m_layoutVersion)
+     * {
+     *     relayout();
+     *     m_layoutVersion = proceduralData.getVersion(DataB);
+     * }
+     * \endcode
+     *
+     * The container is not thread-safe, the callbacks are called synchronously on the modifying thread.
+     *
+     * \tparam T_Key See QSettingsContainer
+     * \tparam T_Storage See QSettingsContainer
+     */
+    template < typename T_Key, typename T_Storage = QSettingsMapStorage<T_Key> >
+    class QObservableSettingsContainer
+    {
+    public:
+        using Container = QSettingsContainer<T_Key, T_Storage>;
+        using Callback  = std::function<void(const T_Key& key, const QVariant& value)>;
+
+        explicit QObservableSettingsContainer(const QString& group)
+            : m_data(group)
+        {
+        }
+
+        //! The observed container, for read access
+        const Container& data() const Q_DECL_NOEXCEPT
+        {
+            return m_data;
+        }
+
+        //! reads procedural settings of the given settings group, notifies about each changed value
+        void read(QSettings& settings)
+        {
+            m_data.read(settings, [this](const T_Key& key, const QVariant& value) { notify(key, value); });
+        }
+
+        //! writes the dirty procedural settings to the given settings group, see QSettingsContainer::write()
+        void write(QSettings& settings)
+        {
+            m_data.write(settings);
+        }
+
+        //! Takes the dirty values and clears the dirty flags, see QSettingsContainer::takeChanges()
+        QSettingsChanges takeChanges()
+        {
+            return m_data.takeChanges();
+        }
+
+        //! Retrieves the dirty values, see QSettingsContainer::getChanges()
+        QSettingsChanges getChanges() const
+        {
+            return m_data.getChanges();
+        }
+
+        //! marks all values as written, e.g. after they have been persisted in some other way
+        void clearDirty()
+        {
+            m_data.clearDirty();
+        }
+
+        //! See QSettingsContainer::value()
+        template < typename T, typename T_Id >
+        T value(const T_Id& index, const T& defaultValue = T(0)) const
+        {
+            return m_data.value(index, defaultValue);
+        }
+
+        //! See QSettingsContainer::contains()
+        template < typename T_Id >
+        bool contains(const T_Id& key) const
+        {
+            return m_data.contains(key);
+        }
+
+        //! Sets a value and notifies the observers of the key if it changed, returns true if the value changed
+        template < typename KeyType >
+        bool setValue(const KeyType& key, const QVariant& value)
+        {
+            const auto dataKey = toDataKey(key, std::is_enum<KeyType>());
+            if(!m_data.setValue(dataKey, value))
+            {
+                return false;
+            }
+
+            notify(dataKey, value);
+            return true;
+        }
+
+        /*!
+         * Registers a callback for the changes of a key
+         * \param key The key, enumeration types are supported
+         * \param callback Called as callback(key, value) after the value of the key changed
+         * \returns The id of the registration, see unobserve()
+         */
+        template < typename KeyType >
+        int observe(const KeyType& key, Callback callback)
+        {
+            m_callbacks[toDataKey(key, std::is_enum<KeyType>())].emplace_back(++m_lastId, std::move(callback));
+            return m_lastId;
+        }
+
+        /*!
+         * Registers a callback for the changes of all keys
+         * \param callback Called as callback(key, value) after any value changed
+         * \returns The id of the registration, see unobserve()
+         */
+        int observe(Callback callback)
+        {
+            m_globalCallbacks.emplace_back(++m_lastId, std::move(callback));
+            return m_lastId;
+        }
+
+        //! Removes a registered callback, see observe()
+        void unobserve(const int id)
+        {
+            const auto matches = [id](const Registration& registration) { return registration.first == id; };
+
+            m_globalCallbacks.erase(std::remove_if(m_globalCallbacks.begin(), m_globalCallbacks.end(), matches),
+                                    m_globalCallbacks.end());
+            for(auto it = m_callbacks.begin(); it != m_callbacks.end();)
+            {
+                auto& registrations = it->second;
+                registrations.erase(std::remove_if(registrations.begin(), registrations.end(), matches),
+                                    registrations.end());
+                it = registrations.empty() ? m_callbacks.erase(it) : std::next(it);
+            }
+        }
+
+        //! The global version, increases with every change of any value
+        quint64 getVersion() const Q_DECL_NOEXCEPT
+        {
+            return m_version;
+        }
+
+        //! The global version of the last change of a key, 0 if it never changed
+        template < typename KeyType >
+        quint64 getVersion(const KeyType& key) const
+        {
+            const auto it = m_versions.find(toLookupKey(key, std::is_enum<KeyType>()));
+            return it != m_versions.end() ? it->second : 0;
+        }
+
+        inline const QString& getGroupName() const
+        {
+            return m_data.getGroupName();
+        }
+
+    private:
+        using Registration = std::pair<int, Callback>;
+
+        Container                                                       m_data;
+        quint64                                                         m_version = 0;      //<! The global version
+        std::map<T_Key, quint64, QSettingsKeyLess>                      m_versions;         //<! The version of each key's last change
+        std::map<T_Key, std::vector<Registration>, QSettingsKeyLess>    m_callbacks;        //<! The callbacks per key
+        std::vector<Registration>                                       m_globalCallbacks;  //<! The callbacks for all keys
+        int                                                             m_lastId = 0;       //<! The last registration id
+
+        template < typename KeyType >
+        static T_Key toDataKey(const KeyType& key, std::true_type)
+        {
+            return static_cast<T_Key>(underlying(key));
+        }
+
+        template < typename KeyType >
+        static T_Key toDataKey(const KeyType& key, std::false_type)
+        {
+            return T_Key(key);
+        }
+
+        template < typename KeyType >
+        static T_Key toLookupKey(const KeyType& key, std::true_type)
+        {
+            return toDataKey(key, std::true_type());
+        }
+
+        template < typename KeyType >
+        static const KeyType& toLookupKey(const KeyType& key, std::false_type)
+        {
+            return key;
+        }
+
+        //! Bumps the versions and calls the callbacks of a changed key
+        void notify(const T_Key& key, const QVariant& value)
+        {
+            m_versions[key] = ++m_version;
+
+            // Copies, so the callbacks may (un)register callbacks themselves
+            auto callbacks = m_globalCallbacks;
+            const auto it  = m_callbacks.find(key);
+            if(it != m_callbacks.end())
+            {
+                callbacks.insert(callbacks.end(), it->second.begin(), it->second.end());
+            }
+            for(const auto& registration : callbacks)
+            {
+                registration.second(key, value);
+            }
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QOBSERVABLESETTINGSCONTAINER_H
@@ -1,8 +1,33 @@
 #ifndef QSETTINGSCONTAINER_H
 #define QSETTINGSCONTAINER_H
 
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QSettings>
+#include <QtCore/QString>
+#include <QtCore/QStringBuilder>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+#include <QtCore/QVector>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "QMetrics.h"
+#include "QSettingsSnapshot.h"
+#include "QSettingsStorage.h"
+
 namespace qtex
 {
+    //! Values as group qualified QSettings keys, e.g. "DataGroupName/0"
+    using QSettingsChanges = QVector<QPair<QString, QVariant>>;
+
+    //! Values of a single settings group, the keys are relative to the group
+    using QSettingsGroupValues = QVector<QPair<QString, QVariant>>;
+
    /*!
     * \class QSettingsContainer
     *
@@ -30,6 +55,9 @@ namespace qtex
     * //or
     * for(auto id = 0; id < underlying(MyContainerIDs::DataCount); ++id)
     *     proceduralData.setValue(id, exampleData[id]);
+    * //or, in bulk
+    * proceduralData.reserve(underlying(MyContainerIDs::DataCount));
+    * proceduralData.setValues(MyContainerIDs::DataA, exampleData.begin(), exampleData.end());
     * \endcode
     *
     * Write the container data to the registry
@@ -37,6 +65,11 @@ namespace qtex
     * proceduralData.write(settings);
     * \endcode
     *
+    * Only the values that changed since the last read() or write() (the dirty values) are written, so
+    * saving a group of several hundred keys after a single change is a single QSettings::setValue().
+    * Setting a value equal to the stored one (in value and type) doesn't mark it dirty. Use writeAll() to write
+    * all values, e.g. to a different QSettings instance.
+    *
     * Read the data back from the registry into the container
     * \code {.cpp}
     * proceduralData.read(settings);
@@ -51,13 +84,39 @@ namespace qtex
     *     exampleData[id] = proceduralData.value(id, 0.f);
     * \endcode
     *
+    * The storage of the values is exchangeable. By default they are kept in a QMap, which works for
+    * arbitrary keys. Enum keys are usually contiguous from 0 to DataCount, for these QSettingsDenseStorage
+    * (or QSettingsArrayStorage if the amount of keys is known at compile time) keeps the values in a flat
+    * array so value(), setValue() and contains() are plain O(1) array accesses.
+    * \code {.cpp}
+    * DenseEnumQSettingsContainer proceduralData("DataGroupName");
+    * //or
+    * FixedEnumQSettingsContainer<underlying(MyContainerIDs::DataCount)> proceduralData("DataGroupName");
+    * \endcode
+    *
+    * Large groups can be read lazily instead. readLazy() only remembers the settings, each key is then read the
+    * first time it is accessed, or in a batch by prefetch(). So keys which are never accessed are never read.
+    * \code {.cpp}
+    * proceduralData.readLazy(settings);
+    * proceduralData.prefetch(std::vector<MyContainerIDs>{DataA, DataB});
+    * \endcode
+    *
+    * The same works with a binary snapshot (see QSettingsSnapshot and saveSnapshot()) as a fast cache in
+    * front of the settings.
+    *
+    * The QSettings key of each integral or std::string key is converted only once and then kept in a key
+    * table, so repeated read() and write() cycles neither format nor parse keys and pass the same shared
+    * QString instances to QSettings. The table is only filled by non-const functions like setValue() and
+    * read(), so const functions like getChanges() or writeAll() stay safe to call concurrently (unless the
+    * container reads lazily, which stores the values on access).
+    *
     * \tparam T_Key Currently can be of type: integral, QString, std::string
+    * \tparam T_Storage The value storage, see QSettingsMapStorage for its interface
     */
-    template < typename T_Key >
+    template < typename T_Key, typename T_Storage = QSettingsMapStorage<T_Key> >
     class QSettingsContainer
     {
-        using CustomDataContainer   = QMap<T_Key, QVariant>;
-        using CustomDataIterator    = QMapIterator<T_Key, QVariant>;
+        using CustomDataContainer   = T_Storage;
 
     public:
         explicit QSettingsContainer(const QString& group) : m_group(group)
@@ -66,87 +125,350 @@ namespace qtex
                             std::is_same<QString, T_Key>::value ||
                             std::is_same<std::string, T_Key>::value,
                             "Key type must be an integral, QString or std::string type.");
+            static_assert(std::is_convertible<T_Key, typename T_Storage::KeyType>::value,
+                            "Key type is not supported by the storage.");
+        }
+
+        QSettingsContainer(const QSettingsContainer&)               = default;
+        QSettingsContainer(QSettingsContainer&&)                    = default;
+        QSettingsContainer& operator=(const QSettingsContainer&)    = default;
+        QSettingsContainer& operator=(QSettingsContainer&&)         = default;
+
+        //! Prepares the storage for count keys, e.g. the keys [0, count) of QSettingsDenseStorage
+        void reserve(const int count)
+        {
+            m_data.reserve(count);
         }
 
         //! reads procedural settings of the given settings group
         void read(QSettings& settings)
         {
+            read(settings, [](const T_Key&, const QVariant&) {});
+        }
+
+        /*!
+         * reads procedural settings of the given settings group
+         * \param settings The settings
+         * \param changed Called as changed(key, value) for each value that differs from the stored one
+         */
+        template < typename Fn >
+        void read(QSettings& settings, Fn&& changed)
+        {
+            assign(fetch(settings), std::forward<Fn>(changed));
+        }
+
+        /*!
+         * Reads the values of the settings group without storing them, see assign().
+         * Splits read() into the QSettings access and the conversion, so the latter can be done elsewhere.
+         * \param settings The settings
+         * \returns The values of the settings group
+         */
+        QSettingsGroupValues fetch(QSettings& settings) const
+        {
+            QTEX_METRIC_SCOPED_TIMER("qsettings.read", m_group);
+
+            QSettingsGroupValues values;
             settings.beginGroup(m_group);
 
             const QStringList keys = settings.childKeys();
+            values.reserve(keys.size());
             for (const auto& key : keys)
             {
-                m_data[toKey<T_Key>(key)] = settings.value(key, QVariant());
+                values.append(qMakePair(key, settings.value(key, QVariant())));
             }
 
             settings.endGroup();
+            QTEX_METRIC_COUNT("qsettings.keysRead", m_group, keys.size());
+            return values;
         }
 
-        //! writes procedural settings to the given settings group
-        void write(QSettings& settings) const
+        //! stores values retrieved by fetch()
+        void assign(const QSettingsGroupValues& values)
         {
-            settings.beginGroup(m_group);
+            assign(values, [](const T_Key&, const QVariant&) {});
+        }
+
+        /*!
+         * stores values retrieved by fetch()
+         * \param values The values of the settings group
+         * \param changed Called as changed(key, value) for each value that differs from the stored one
+         */
+        template < typename Fn >
+        void assign(const QSettingsGroupValues& values, Fn&& changed)
+        {
+            m_source = nullptr;
+            m_snapshot.reset();
+            m_missing.clear();
+
+            for (const auto& value : values)
+            {
+                const auto dataKey = keyOf(value.first);
+                if(m_data.set(dataKey, value.second, false))
+                {
+                    changed(dataKey, value.second);
+                }
+            }
+        }
+
+        /*!
+         * Attaches the container to the given settings group without reading anything. Each key is read
+         * the first time it is accessed by value() or contains(), see prefetch() for reading batches of keys.
+         * Values which are not accessed yet are not written by writeAll().
+         * \param settings The settings, must outlive the container (or the next read()) and must not be
+         * within a group when the container reads from it
+         */
+        void readLazy(QSettings& settings)
+        {
+            m_source = &settings;
+            m_snapshot.reset();
+            m_missing.clear();
+        }
+
+        /*!
+         * Attaches the container to a binary snapshot without decoding anything, like readLazy(QSettings&)
+         * \param snapshot The snapshot, see QSettingsSnapshot::open()
+         */
+        void readLazy(std::shared_ptr<const QSettingsSnapshot> snapshot)
+        {
+            m_source   = nullptr;
+            m_snapshot = std::move(snapshot);
+            m_missing.clear();
+        }
+
+        /*!
+         * Saves the stored values as a binary snapshot, e.g. as a cache for the next start
+         * \param path The path of the snapshot file
+         * \param stamp The staleness stamp, see QSettingsSnapshot::open()
+         * \returns True on success
+         */
+        bool saveSnapshot(const QString& path, const qint64 stamp) const
+        {
+            QSettingsSnapshot::Values values;
+            values.reserve(m_data.size());
+            m_data.forEach([this, &values](const T_Key& key, const QVariant& value)
+            {
+                values.append(qMakePair(nameOf(key), value));
+            });
+            return QSettingsSnapshot::write(path, values, stamp);
+        }
+
+        /*!
+         * Reads the given keys in a single group pass, if attached by readLazy() and not read yet
+         * \param keys The keys, a range of any supported key type including enumeration types
+         */
+        template < typename Keys >
+        void prefetch(const Keys& keys)
+        {
+            if(!m_source && !m_snapshot)
+            {
+                return;
+            }
 
-            CustomDataIterator iter(m_data);
-            while (iter.hasNext())
+            if(m_source)
             {
-                iter.next();
-                settings.setValue(fromKey<T_Key>(iter.key()), iter.value());
+                m_source->beginGroup(m_group);
             }
+            for(const auto& key : keys)
+            {
+                const auto dataKey = toDataKey(key, std::is_enum<typename std::decay<decltype(key)>::type>());
+                if(!m_data.contains(dataKey) && m_missing.find(dataKey) == m_missing.end())
+                {
+                    addName(dataKey);
+                    const auto& name = nameOf(dataKey);
+                    store(dataKey, m_source ? m_source->value(name) : m_snapshot->value(name));
+                }
+            }
+            if(m_source)
+            {
+                m_source->endGroup();
+            }
+        }
+
+        //! writes the dirty procedural settings to the given settings group and clears the dirty flags
+        void write(QSettings& settings)
+        {
+            if(!m_data.isDirty())
+            {
+                return;
+            }
+
+            QTEX_METRIC_SCOPED_TIMER("qsettings.write", m_group);
+            settings.beginGroup(m_group);
+
+            auto written = 0;
+            m_data.forEachDirty([this, &settings, &written](const T_Key& key, const QVariant& value)
+            {
+                settings.setValue(nameOf(key), value);
+                ++written;
+            });
 
             settings.endGroup();
+            m_data.clearDirty();
+            QTEX_METRIC_COUNT("qsettings.keysWritten", m_group, written);
         }
 
-        //! This one handles enumeration types
-        template <typename T, typename T_Id>
-        T value(const T_Id index, const T& defaultValue = T(0)) const
+        //! writes all procedural settings to the given settings group, the dirty flags are left untouched
+        void writeAll(QSettings& settings) const
         {
-            static_assert(std::is_enum<T_Id>::value, "Passed index variable is not an enumeration type and no supported key type.");
+            QTEX_METRIC_SCOPED_TIMER("qsettings.write", m_group);
+            settings.beginGroup(m_group);
 
-            auto iIndex = underlying(index);
-            if (!m_data.contains(iIndex))
-                return defaultValue;
+            m_data.forEach([this, &settings](const T_Key& key, const QVariant& value)
+            {
+                settings.setValue(nameOf(key), value);
+            });
 
-            return m_data.value(iIndex, defaultValue).template value<T>();
+            settings.endGroup();
+            QTEX_METRIC_COUNT("qsettings.keysWritten", m_group, m_data.size());
         }
 
-        //! This one handles the supported key types
-        template <typename T>
-        T value(const T_Key index, const T& defaultValue = T(0)) const
+        /*!
+         * Takes the dirty values and clears the dirty flags, e.g. to persist them with a QSettingsWriter
+         * \returns The dirty values as group qualified QSettings keys
+         */
+        QSettingsChanges takeChanges()
         {
-            if (!m_data.contains(index))
-                return defaultValue;
+            auto changes = getChanges();
+            m_data.clearDirty();
+            return changes;
+        }
 
-            return m_data.value(index, defaultValue).template value<T>();
+        /*!
+         * Retrieves the dirty values, the dirty flags are left untouched (see QSettingsTransaction)
+         * \returns The dirty values as group qualified QSettings keys
+         */
+        QSettingsChanges getChanges() const
+        {
+            QSettingsChanges changes;
+            const auto prefix = m_group.isEmpty() ? QString() : QString(m_group % QLatin1Char('/'));
+            m_data.forEachDirty([this, &changes, &prefix](const T_Key& key, const QVariant& value)
+            {
+                const QString settingsKey = prefix % nameOf(key);
+                changes.append(qMakePair(settingsKey, value));
+            });
+            return changes;
         }
 
         //! This one handles enumeration types
-        template < typename KeyType >
-        void setValue(KeyType key, const QVariant& value)
+        template < typename T, typename T_Id, typename = typename std::enable_if<std::is_enum<T_Id>::value>::type >
+        T value(const T_Id index, const T& defaultValue = T(0)) const
         {
-            static_assert(std::is_enum<KeyType>::value, "Key is not an enumeration type and no supported key type.");
+            const auto* stored = lookup(underlying(index));
+            return stored ? convert<T>(*stored) : defaultValue;
+        }
 
-            m_data[underlying(key)] = value;
+        /*!
+         * This one handles the supported key types and types comparable to them, which are looked up
+         * without constructing a key, e.g. a const char* or std::string_view for std::string keys or a
+         * QLatin1String or QStringView for QString keys (see QSettingsKeyLess)
+         */
+        template < typename T, typename T_Lookup, typename = typename std::enable_if<!std::is_enum<T_Lookup>::value>::type >
+        T value(const T_Lookup& index, const T& defaultValue = T(0)) const
+        {
+            const auto* stored = lookup(index);
+            return stored ? convert<T>(*stored) : defaultValue;
+        }
+
+        //! This one handles enumeration types, returns true if the value changed
+        template < typename KeyType, typename = typename std::enable_if<std::is_enum<KeyType>::value>::type >
+        bool setValue(KeyType key, const QVariant& value)
+        {
+            return setValue(static_cast<T_Key>(underlying(key)), value);
+        }
+
+        //! This one handles enumeration types and moves the value, returns true if the value changed
+        template < typename KeyType, typename = typename std::enable_if<std::is_enum<KeyType>::value>::type >
+        bool setValue(KeyType key, QVariant&& value)
+        {
+            return setValue(static_cast<T_Key>(underlying(key)), std::move(value));
         }
 
-        //! This one handles the supported key types
-        void setValue(T_Key key, const QVariant& value)
+        //! This one handles the supported key types, returns true if the value changed
+        bool setValue(T_Key key, const QVariant& value)
         {
-            m_data[key] = value;
+            if(!m_data.set(key, value, true))
+            {
+                return false;
+            }
+            addName(key);
+            return true;
+        }
+
+        //! This one handles the supported key types and moves the value, returns true if the value changed
+        bool setValue(T_Key key, QVariant&& value)
+        {
+            if(!m_data.set(key, std::move(value), true))
+            {
+                return false;
+            }
+            addName(key);
+            return true;
+        }
+
+        /*!
+         * Sets the values of consecutive integral (or enum) keys
+         * \param beginKey The key of the first value, the following values get the subsequent keys
+         * \param first The first value, e.g. of a std::vector<float>. Values are converted by QVariant::fromValue(),
+         * QVariant elements are moved if the iterators yield rvalues (e.g. std::make_move_iterator())
+         * \param last The end of the values
+         * \returns The amount of values that changed
+         */
+        template < typename KeyType, typename It >
+        int setValues(const KeyType beginKey, It first, const It last)
+        {
+            static_assert(std::is_integral<T_Key>::value, "Consecutive keys require an integral key type.");
+
+            auto key     = static_cast<T_Key>(toDataKey(beginKey, std::is_enum<KeyType>()));
+            auto changed = 0;
+            for(; first != last; ++first, ++key)
+            {
+                if(m_data.set(key, toVariant(*first), true))
+                {
+                    addName(key);
+                    ++changed;
+                }
+            }
+            return changed;
         }
 
         //! This one handles enumeration types
-        template < typename KeyType >
+        template < typename KeyType, typename = typename std::enable_if<std::is_enum<KeyType>::value>::type >
         bool contains(KeyType key) const
         {
-            static_assert(std::is_enum<KeyType>::value, "Key is not an enumeration type and no supported key type.");
-            return m_data.contains(underlying(key));
+            return lookup(underlying(key)) != nullptr;
         }
 
-        //! This one handles the supported key types
-        bool contains(T_Key key) const
+        //! This one handles the supported key types and types comparable to them, see value()
+        template < typename T_Lookup, typename = typename std::enable_if<!std::is_enum<T_Lookup>::value>::type >
+        bool contains(const T_Lookup& key) const
         {
-            return m_data.contains(key);
+            return lookup(key) != nullptr;
+        }
+
+        //! This one handles enumeration types, returns true if the value changed since the last write
+        template < typename KeyType, typename = typename std::enable_if<std::is_enum<KeyType>::value>::type >
+        bool isDirty(KeyType key) const
+        {
+            return m_data.isDirty(underlying(key));
+        }
+
+        //! This one handles the supported key types and types comparable to them, see value()
+        template < typename T_Lookup, typename = typename std::enable_if<!std::is_enum<T_Lookup>::value>::type >
+        bool isDirty(const T_Lookup& key) const
+        {
+            return m_data.isDirty(key);
+        }
+
+        //! returns true if any value changed since the last write
+        bool isDirty() const
+        {
+            return m_data.isDirty();
+        }
+
+        //! marks all values as written, e.g. after they have been persisted in some other way
+        void clearDirty()
+        {
+            m_data.clearDirty();
         }
 
         inline const QString& getGroupName() const
@@ -156,48 +478,207 @@ namespace qtex
 
     private:
         QString m_group;
-        CustomDataContainer m_data;
+        mutable CustomDataContainer m_data;     //<! Mutable, so lazily read values can be stored on access
+
+        QSettings*                                  m_source = nullptr; //<! The settings to read lazily from, see readLazy()
+        std::shared_ptr<const QSettingsSnapshot>    m_snapshot;         //<! The snapshot to read lazily from, see readLazy()
+        mutable std::set<T_Key, QSettingsKeyLess>   m_missing;          //<! Keys lazily read but not found
+        std::map<T_Key, QString, QSettingsKeyLess>  m_names;    //<! The key table, the QSettings key of each key
+        QHash<QString, T_Key>                       m_keys;     //<! The key table, the key of each QSettings key
+
+        /*!
+         * Retrieves the QSettings key of a key out of the key table, converts keys not in the table.
+         * Only reads the table, so const members stay safe to call concurrently (see QConcurrentSettingsContainer).
+         */
+        QString nameOf(const T_Key& key) const
+        {
+            return nameOf(key, std::is_same<T_Key, QString>());
+        }
+
+        template < typename KeyType >
+        QString nameOf(const KeyType& key, std::true_type) const
+        {
+            return key;
+        }
 
-        //! Primary template that converts the QSettings key (QString) to the custom data key type if it's an integral
         template < typename KeyType >
-        KeyType toKey(const QString& key) const
+        QString nameOf(const KeyType& key, std::false_type) const
+        {
+            const auto it = m_names.find(key);
+            return it != m_names.end() ? it->second : fromKey(key);
+        }
+
+        //! Adds a key to the key table, e.g. once its value has to be written. Converts it only on first use.
+        void addName(const T_Key& key)
+        {
+            addName(key, std::is_same<T_Key, QString>());
+        }
+
+        template < typename KeyType >
+        void addName(const KeyType&, std::true_type)
+        {
+        }
+
+        template < typename KeyType >
+        void addName(const KeyType& key, std::false_type)
+        {
+            const auto it = m_names.lower_bound(key);
+            if(it == m_names.end() || m_names.key_comp()(key, it->first))
+            {
+                const auto added = m_names.emplace_hint(it, key, fromKey(key));
+                m_keys.insert(added->second, key);
+            }
+        }
+
+        //! Retrieves the key of a QSettings key out of the key table, converts it only on first use
+        T_Key keyOf(const QString& name)
+        {
+            return keyOf(name, std::is_same<T_Key, QString>());
+        }
+
+        T_Key keyOf(const QString& name, std::true_type)
+        {
+            return T_Key(name);
+        }
+
+        T_Key keyOf(const QString& name, std::false_type)
+        {
+            const auto it = m_keys.constFind(name);
+            if(it != m_keys.constEnd())
+            {
+                return it.value();
+            }
+
+            // Reuses the QSettings key as read, so writing addresses the very same entry
+            const auto key = toKey(name, static_cast<T_Key*>(nullptr));
+            m_names.emplace(key, name);
+            m_keys.insert(name, key);
+            return key;
+        }
+
+        //! Finds a stored value, reads it if it has not been read yet in lazy mode
+        template < typename T_Lookup >
+        const QVariant* lookup(const T_Lookup& key) const
+        {
+            const auto* stored = m_data.find(key);
+            if(stored || (!m_source && !m_snapshot))
+            {
+                return stored;
+            }
+
+            const auto dataKey = toDataKey(key, std::false_type());
+            if(m_missing.find(dataKey) != m_missing.end())
+            {
+                return nullptr;
+            }
+
+            if(m_snapshot)
+            {
+                return store(dataKey, m_snapshot->value(nameOf(dataKey)));
+            }
+
+            const QString settingsKey = m_group.isEmpty() ? nameOf(dataKey)
+                                                          : QString(m_group % QLatin1Char('/') % nameOf(dataKey));
+            return store(dataKey, m_source->value(settingsKey));
+        }
+
+        //! Converts a stored value, counts the values not convertible to the requested type
+        template < typename T >
+        T convert(const QVariant& value) const
+        {
+#ifdef QTEX_ENABLE_METRICS
+            if(!value.canConvert<T>())
+            {
+                QTEX_METRIC_COUNT("qsettings.conversionFailures", m_group, 1);
+            }
+#endif
+            return value.template value<T>();
+        }
+
+        static const QVariant& toVariant(const QVariant& value) Q_DECL_NOEXCEPT
+        {
+            return value;
+        }
+
+        static QVariant&& toVariant(QVariant&& value) Q_DECL_NOEXCEPT
+        {
+            return std::move(value);
+        }
+
+        template < typename T >
+        static QVariant toVariant(const T& value)
+        {
+            return QVariant::fromValue(value);
+        }
+
+        //! Stores a lazily read value, remembers the key as missing if the value is invalid
+        const QVariant* store(const T_Key& key, const QVariant& value) const
+        {
+            if(!value.isValid())
+            {
+                m_missing.insert(key);
+                return nullptr;
+            }
+
+            m_data.set(key, value, false);
+            return m_data.find(key);
+        }
+
+        template < typename KeyType >
+        static T_Key toDataKey(const KeyType& key, std::true_type)
+        {
+            return static_cast<T_Key>(underlying(key));
+        }
+
+        template < typename KeyType >
+        static T_Key toDataKey(const KeyType& key, std::false_type)
+        {
+            return T_Key(key);
+        }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        static QString toDataKey(const QStringView key, std::false_type)
+        {
+            return key.toString();
+        }
+#endif
+
+        //! Converts the QSettings key (QString) to the custom data key type if it's an integral
+        template < typename KeyType >
+        static KeyType toKey(const QString& key, KeyType*)
         {
             return static_cast<KeyType>(key.toInt());
         }
 
-        //! Partial Specialization converts the QSettings key (QString) to the custom data key type if it's a QString
-        template < >
-        QString toKey(const QString& key) const
+        //! Converts the QSettings key (QString) to the custom data key type if it's a QString
+        static QString toKey(const QString& key, QString*)
         {
             return key;
         }
 
-        //! Partial Specialization converts the QSettings key (QString) to the custom data key type if it's a std::string
-        template < >
-        std::string toKey(const QString& key) const
+        //! Converts the QSettings key (QString) to the custom data key type if it's a std::string
+        static std::string toKey(const QString& key, std::string*)
         {
             return key.toStdString();
         }
 
-        //! Primary template that converts the integral custom data key type to the QSettings key (QString)
+        //! Converts the integral custom data key type to the QSettings key (QString)
         template < typename KeyType >
-        QString fromKey(const KeyType& key) const
+        static QString fromKey(const KeyType& key)
         {
             return QString::number(key);
         }
 
-        //! Partial Specialization that converts a custom data key type to the QSettings key (QString)
-        template < >
-        QString fromKey(const QString& key) const
+        //! Converts a QString custom data key type to the QSettings key (QString)
+        static QString fromKey(const QString& key)
         {
             return key;
         }
 
-        //! Partial Specialization that converts a std::string custom data key type to the QSettings key (QString)
-        template < >
-        QString fromKey(const std::string& key) const
+        //! Converts a std::string custom data key type to the QSettings key (QString)
+        static QString fromKey(const std::string& key)
         {
-            return QString::fromStdString(s);
+            return QString::fromStdString(key);
         }
     };
 }
@@ -205,5 +686,9 @@ namespace qtex
 using EnumQSettingsContainer        = qtex::QSettingsContainer<int>;
 using StringQSettingsContainer      = qtex::QSettingsContainer<QString>;
 using StdStringQSettingsContainer   = qtex::QSettingsContainer<std::string>;
+using DenseEnumQSettingsContainer   = qtex::QSettingsContainer<int, qtex::QSettingsDenseStorage>;
+
+template < std::size_t Count >
+using FixedEnumQSettingsContainer   = qtex::QSettingsContainer<int, qtex::QSettingsArrayStorage<Count>>;
 
 #endif // QSETTINGSCONTAINER_H
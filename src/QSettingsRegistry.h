@@ -0,0 +1,182 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QSETTINGSREGISTRY_H
+#define QSETTINGSREGISTRY_H
+
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtCore/QSettings>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "QSettingsContainer.h"
+
+namespace qtex
+{
+    /*!
+     * \class QSettingsRegistry
+     * \brief Owns a set of settings containers and reads or writes them all in a single pass
+     *
+     * Instead of reading dozens of containers one after another, possibly each with its own QSettings
+     * instance reopening the backend, the registry reads all groups through one QSettings instance and
+     * writes all dirty values followed by a single sync().
+     *
+     * Reading is split into fetching the raw values of each group, which has to be done sequentially on
+     * the QSettings instance, and assigning them to the containers, which converts the keys and stores the
+     * values. With ReadMode::Parallel the latter is done for the independent containers concurrently.
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * QSettingsRegistry registry;
+     * auto& view    = registry.add<EnumQSettingsContainer>("View");
+     * auto& recent  = registry.add<StringQSettingsContainer>("RecentFiles");
+     *
+     * QSettings settings;
+     * registry.read(settings, QSettingsRegistry::ReadMode::Parallel);
+     * ...
+     * registry.write(settings);
+     * \endcode
+     *
+     * A container type must provide fetch(), assign(), write() and writeAll() like QSettingsContainer.
+     */
+    class QSettingsRegistry
+    {
+    public:
+        enum class ReadMode
+        {
+            Sequential, //<! Assign the values of all groups on the calling thread
+            Parallel    //<! Assign the values of independent groups concurrently, using the global thread pool
+        };
+
+        QSettingsRegistry() = default;
+        QSettingsRegistry(const QSettingsRegistry&) = delete;
+        QSettingsRegistry& operator=(const QSettingsRegistry&) = delete;
+
+        /*!
+         * Constructs a container owned by the registry
+         * \param args The constructor arguments of the container, usually the settings group name
+         * \returns The container, valid as long as the registry
+         */
+        template < typename Container, typename... Args >
+        Container& add(Args&&... args)
+        {
+            auto* holder = new Holder<Container>(std::forward<Args>(args)...);
+            m_entries.emplace_back(holder);
+            return holder->container;
+        }
+
+        /*!
+         * Reads all containers through a single settings instance
+         * \param settings The settings
+         * \param mode Whether the values are assigned to the containers sequentially or in parallel
+         */
+        void read(QSettings& settings, const ReadMode mode = ReadMode::Sequential)
+        {
+            std::vector<Pending> pending;
+            pending.reserve(m_entries.size());
+            for(const auto& entry : m_entries)
+            {
+                pending.push_back(Pending{entry.get(), entry->fetch(settings)});
+            }
+
+            const auto assign = [](Pending& item) { item.entry->assign(item.values); };
+            if(mode == ReadMode::Parallel && pending.size() > 1)
+            {
+                QtConcurrent::blockingMap(pending, assign);
+            }
+            else
+            {
+                for(auto& item : pending)
+                {
+                    assign(item);
+                }
+            }
+        }
+
+        //! Writes the dirty values of all containers and syncs the settings once
+        void write(QSettings& settings)
+        {
+            for(const auto& entry : m_entries)
+            {
+                entry->write(settings);
+            }
+            settings.sync();
+        }
+
+        //! Writes all values of all containers and syncs the settings once
+        void writeAll(QSettings& settings) const
+        {
+            for(const auto& entry : m_entries)
+            {
+                entry->writeAll(settings);
+            }
+            settings.sync();
+        }
+
+        //! The amount of containers
+        int size() const Q_DECL_NOEXCEPT
+        {
+            return static_cast<int>(m_entries.size());
+        }
+
+    private:
+        //! Type erased container
+        struct Entry
+        {
+            virtual ~Entry() = default;
+            virtual QSettingsGroupValues fetch(QSettings& settings) const = 0;
+            virtual void assign(const QSettingsGroupValues& values) = 0;
+            virtual void write(QSettings& settings) = 0;
+            virtual void writeAll(QSettings& settings) const = 0;
+        };
+
+        template < typename Container >
+        struct Holder : public Entry
+        {
+            template < typename... Args >
+            explicit Holder(Args&&... args) : container(std::forward<Args>(args)...)
+            {
+            }
+
+            QSettingsGroupValues fetch(QSettings& settings) const override
+            {
+                return container.fetch(settings);
+            }
+
+            void assign(const QSettingsGroupValues& values) override
+            {
+                container.assign(values);
+            }
+
+            void write(QSettings& settings) override
+            {
+                container.write(settings);
+            }
+
+            void writeAll(QSettings& settings) const override
+            {
+                container.writeAll(settings);
+            }
+
+            Container container;
+        };
+
+        //! The fetched values of a group waiting to be assigned
+        struct Pending
+        {
+            Entry*                  entry;
+            QSettingsGroupValues    values;
+        };
+
+        std::vector<std::unique_ptr<Entry>> m_entries;  //<! The containers in the order they have been added
+    };
+}    // namespace qtex
+
+
+#endif    // QSETTINGSREGISTRY_H
@@ -0,0 +1,414 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QSETTINGSSNAPSHOT_H
+#define QSETTINGSSNAPSHOT_H
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QPair>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSettings>
+#include <QtCore/QString>
+#include <QtCore/QVariant>
+#include <QtCore/QVector>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace qtex
+{
+    /*!
+     * \class QSettingsSnapshot
+     * \brief Compact binary snapshot of a settings group which is loaded by memory-mapping it
+     *
+     * Meant as a fast local cache in front of the authoritative QSettings store, avoiding the INI or
+     * registry parsing. The file consists of
+     * - a fixed size header holding the amount of keys and the staleness stamp
+     * - a key table sorted by key, each entry referencing the key characters and the value record
+     * - the UTF-16 key characters and the value records, each a type tag and a byte length followed by
+     *   the payload. Booleans, integers, doubles, strings and byte arrays are stored raw, all other types
+     *   are serialized with QDataStream.
+     *
+     * Opening a snapshot maps the file and validates the header and the key table, no value is decoded. A lookup is a binary
+     * search over the mapped key table and a value is only decoded when it is retrieved.
+     *
+     * The stamp is an arbitrary number written along with the snapshot which must match on opening,
+     * otherwise the snapshot is considered stale. stampOf() provides the modification time of file based
+     * settings, for the registry provide your own stamp (e.g. a version number stored in the settings).
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * const auto stamp = QSettingsSnapshot::stampOf(settings);
+     * if(auto snapshot = QSettingsSnapshot::open(cachePath, stamp))
+     *     proceduralData.readLazy(snapshot);
+     * else
+     * {
+     *     proceduralData.read(settings);
+     *     proceduralData.saveSnapshot(cachePath, stamp);
+     * }
+     * \endcode
+     *
+     * The data is stored in native byte order, a snapshot of different endianness is treated as stale.
+     */
+    class QSettingsSnapshot
+    {
+    public:
+        //! Values of a settings group, the keys are relative to the group
+        using Values = QVector<QPair<QString, QVariant>>;
+
+        /*!
+         * Writes a snapshot
+         * \param path The path of the snapshot file
+         * \param values The values to store, the keys have to be unique
+         * \param stamp The staleness stamp, see open()
+         * \returns True on success
+         */
+        static bool write(const QString& path, const Values& values, const qint64 stamp)
+        {
+            std::vector<int> order(values.size());
+            for(auto index = 0; index < values.size(); ++index)
+            {
+                order[index] = index;
+            }
+            std::sort(order.begin(), order.end(), [&values](const int a, const int b)
+            {
+                return values[a].first < values[b].first;
+            });
+
+            // Keys and value records are laid out in the data area, the table references them
+            QByteArray          data;
+            std::vector<Entry>  table;
+            table.reserve(order.size());
+            for(const auto index : order)
+            {
+                const auto& key = values[index].first;
+
+                Entry entry;
+                entry.keyOffset = static_cast<quint32>(data.size());
+                entry.keyLength = static_cast<quint32>(key.size());
+                data.append(reinterpret_cast<const char*>(key.constData()), key.size() * static_cast<int>(sizeof(QChar)));
+                data.append(QByteArray(padding(data.size()), '\0'));
+
+                entry.valueOffset = static_cast<quint32>(data.size());
+                appendValue(data, values[index].second);
+                data.append(QByteArray(padding(data.size()), '\0'));
+                table.push_back(entry);
+            }
+
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            header.magic        = Magic;
+            header.version      = Version;
+            header.byteOrder    = ByteOrder;
+            header.count        = static_cast<quint32>(table.size());
+            header.stamp        = stamp;
+            header.dataOffset   = sizeof(Header) + table.size() * sizeof(Entry);
+
+            QSaveFile file(path);
+            if(!file.open(QIODevice::WriteOnly))
+            {
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            if(!table.empty())
+            {
+                file.write(reinterpret_cast<const char*>(table.data()), static_cast<qint64>(table.size() * sizeof(Entry)));
+            }
+            file.write(data);
+            return file.commit();
+        }
+
+        /*!
+         * Opens a snapshot by memory-mapping it
+         * \param path The path of the snapshot file
+         * \param stamp The staleness stamp the snapshot must have been written with
+         * \returns The snapshot, nullptr if the file does not exist, is stale or corrupt
+         */
+        static std::shared_ptr<const QSettingsSnapshot> open(const QString& path, const qint64 stamp)
+        {
+            auto file = std::make_shared<QFile>(path);
+            if(!file->open(QIODevice::ReadOnly) || file->size() < static_cast<qint64>(sizeof(Header)))
+            {
+                return nullptr;
+            }
+
+            const auto* data = file->map(0, file->size());
+            if(!data)
+            {
+                return nullptr;
+            }
+
+            Header header;
+            std::memcpy(&header, data, sizeof(header));
+            if(header.magic != Magic || header.version != Version || header.byteOrder != ByteOrder ||
+               header.stamp != stamp ||
+               header.dataOffset != static_cast<qint64>(sizeof(Header) + header.count * sizeof(Entry)) ||
+               header.dataOffset > file->size())
+            {
+                return nullptr;
+            }
+
+            std::shared_ptr<QSettingsSnapshot> snapshot(new QSettingsSnapshot());
+            snapshot->m_table    = reinterpret_cast<const Entry*>(data + sizeof(Header));
+            snapshot->m_count    = static_cast<int>(header.count);
+            snapshot->m_data     = data + header.dataOffset;
+            snapshot->m_dataSize = file->size() - header.dataOffset;
+            snapshot->m_file     = std::move(file);
+            return snapshot->isConsistent() ? snapshot : nullptr;
+        }
+
+        /*!
+         * Retrieves a staleness stamp for file based settings
+         * \param settings The settings
+         * \returns The modification time of the settings file in milliseconds since the epoch, 0 if there is no such file
+         */
+        static qint64 stampOf(const QSettings& settings)
+        {
+            const QFileInfo info(settings.fileName());
+            return info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+        }
+
+        //! The amount of keys
+        int size() const Q_DECL_NOEXCEPT
+        {
+            return m_count;
+        }
+
+        //! True if the snapshot contains the key
+        bool contains(const QString& key) const
+        {
+            return find(key) >= 0;
+        }
+
+        //! Decodes the value of a key, invalid if there is no such key
+        QVariant value(const QString& key) const
+        {
+            const auto index = find(key);
+            return index >= 0 ? valueAt(index) : QVariant();
+        }
+
+        //! The key at a position of the sorted key table
+        QString keyAt(const int index) const
+        {
+            const auto& entry = m_table[index];
+            return QString(reinterpret_cast<const QChar*>(m_data + entry.keyOffset), static_cast<int>(entry.keyLength));
+        }
+
+        //! Decodes the value at a position of the sorted key table
+        QVariant valueAt(const int index) const
+        {
+            const auto* record = m_data + m_table[index].valueOffset;
+
+            quint32 tag    = 0;
+            quint32 length = 0;
+            std::memcpy(&tag, record, sizeof(tag));
+            std::memcpy(&length, record + sizeof(tag), sizeof(length));
+
+            const auto* payload = reinterpret_cast<const char*>(record + RecordHeader);
+            switch(tag)
+            {
+                case TagBool:
+                    return QVariant(*payload != 0);
+                case TagInt:
+                {
+                    qint64 value = 0;
+                    std::memcpy(&value, payload, sizeof(value));
+                    return QVariant(static_cast<int>(value));
+                }
+                case TagDouble:
+                {
+                    double value = 0.0;
+                    std::memcpy(&value, payload, sizeof(value));
+                    return QVariant(value);
+                }
+                case TagString:
+                    return QVariant(QString(reinterpret_cast<const QChar*>(payload), static_cast<int>(length / sizeof(QChar))));
+                case TagByteArray:
+                    return QVariant(QByteArray(payload, static_cast<int>(length)));
+                case TagVariant:
+                {
+                    QVariant value;
+                    QDataStream stream(QByteArray::fromRawData(payload, static_cast<int>(length)));
+                    stream.setVersion(QDataStream::Qt_5_6);
+                    stream >> value;
+                    return value;
+                }
+                default:
+                    return QVariant();
+            }
+        }
+
+    private:
+        static const quint32 Magic          = 0x4e535351;   //<! "QSSN" in little endian
+        static const quint32 Version        = 1;
+        static const quint32 ByteOrder      = 0x01020304;   //<! Reads differently on a machine of different endianness
+        static const int     RecordHeader   = 8;            //<! The size of a value record's tag and length
+
+        enum Tag : quint32
+        {
+            TagInvalid,
+            TagBool,
+            TagInt,
+            TagDouble,
+            TagString,
+            TagByteArray,
+            TagVariant
+        };
+
+        //! The fixed size file header, naturally aligned so it can be copied straight out of the mapping
+        struct Header
+        {
+            quint32 magic;
+            quint32 version;
+            quint32 byteOrder;
+            quint32 count;
+            qint64  stamp;
+            qint64  dataOffset;
+        };
+
+        //! A key table entry, the offsets are relative to the data area
+        struct Entry
+        {
+            quint32 keyOffset;
+            quint32 keyLength;      //<! In UTF-16 code units
+            quint32 valueOffset;
+        };
+
+        std::shared_ptr<QFile>  m_file;             //<! Keeps the file mapped
+        const Entry*            m_table = nullptr;  //<! The mapped key table
+        int                     m_count = 0;
+        const uchar*            m_data = nullptr;   //<! The mapped data area
+        qint64                  m_dataSize = 0;
+
+        QSettingsSnapshot() = default;
+
+        //! Binary search over the key table, returns -1 if there is no such key
+        int find(const QString& key) const
+        {
+            auto first = 0;
+            auto last  = m_count;
+            while(first < last)
+            {
+                const auto middle = first + (last - first) / 2;
+                const auto& entry = m_table[middle];
+                const auto other  = QString::fromRawData(reinterpret_cast<const QChar*>(m_data + entry.keyOffset),
+                                                         static_cast<int>(entry.keyLength));
+                const auto result = QString::compare(other, key);
+                if(result == 0)
+                {
+                    return middle;
+                }
+                if(result < 0)
+                {
+                    first = middle + 1;
+                }
+                else
+                {
+                    last = middle;
+                }
+            }
+            return -1;
+        }
+
+        //! Checks all table entries to reference data within the file
+        bool isConsistent() const
+        {
+            for(auto index = 0; index < m_count; ++index)
+            {
+                const auto& entry = m_table[index];
+                if(entry.keyOffset + static_cast<qint64>(entry.keyLength * sizeof(QChar)) > m_dataSize ||
+                   entry.valueOffset + static_cast<qint64>(RecordHeader) > m_dataSize)
+                {
+                    return false;
+                }
+
+                quint32 length = 0;
+                std::memcpy(&length, m_data + entry.valueOffset + sizeof(quint32), sizeof(length));
+                if(entry.valueOffset + static_cast<qint64>(RecordHeader) + length > m_dataSize)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //! Keeps the records 8 byte aligned
+        static int padding(const int size) Q_DECL_NOEXCEPT
+        {
+            return (8 - size % 8) % 8;
+        }
+
+        static void appendRecord(QByteArray& data, const quint32 tag, const char* payload, const quint32 length)
+        {
+            data.append(reinterpret_cast<const char*>(&tag), sizeof(tag));
+            data.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            data.append(payload, static_cast<int>(length));
+        }
+
+        static void appendValue(QByteArray& data, const QVariant& value)
+        {
+            switch(value.userType())
+            {
+                case QMetaType::Bool:
+                {
+                    const char payload = value.toBool() ? 1 : 0;
+                    appendRecord(data, TagBool, &payload, 1);
+                    break;
+                }
+                case QMetaType::Int:
+                {
+                    const qint64 payload = value.toInt();
+                    appendRecord(data, TagInt, reinterpret_cast<const char*>(&payload), sizeof(payload));
+                    break;
+                }
+                case QMetaType::Double:
+                {
+                    const double payload = value.toDouble();
+                    appendRecord(data, TagDouble, reinterpret_cast<const char*>(&payload), sizeof(payload));
+                    break;
+                }
+                case QMetaType::QString:
+                {
+                    const auto payload = value.toString();
+                    appendRecord(data, TagString, reinterpret_cast<const char*>(payload.constData()),
+                                 static_cast<quint32>(payload.size() * sizeof(QChar)));
+                    break;
+                }
+                case QMetaType::QByteArray:
+                {
+                    const auto payload = value.toByteArray();
+                    appendRecord(data, TagByteArray, payload.constData(), static_cast<quint32>(payload.size()));
+                    break;
+                }
+                default:
+                {
+                    if(!value.isValid())
+                    {
+                        appendRecord(data, TagInvalid, nullptr, 0);
+                        break;
+                    }
+
+                    QByteArray payload;
+                    QDataStream stream(&payload, QIODevice::WriteOnly);
+                    stream.setVersion(QDataStream::Qt_5_6);
+                    stream << value;
+                    appendRecord(data, TagVariant, payload.constData(), static_cast<quint32>(payload.size()));
+                    break;
+                }
+            }
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QSETTINGSSNAPSHOT_H
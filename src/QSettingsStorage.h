@@ -0,0 +1,473 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QSETTINGSSTORAGE_H
+#define QSETTINGSSTORAGE_H
+
+#include <QtCore/QString>
+#include <QtCore/QVariant>
+#include <QtCore/QtGlobal>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QtCore/QStringView>
+#endif
+
+namespace qtex
+{
+    /*!
+     * Compares a stored value with a new one for QSettingsContainer::setValue() and read()
+     * \param stored The stored value
+     * \param value The new value
+     * \param strict True to also compare the types, QVariant::operator==() converts between them, so
+     * e.g. true would equal 1. Values read from QSettings are compared loosely, as e.g. INI files
+     * return all values as strings.
+     * \returns True if the value is unchanged
+     */
+    inline bool isSameSettingsValue(const QVariant& stored, const QVariant& value, const bool strict)
+    {
+        return (!strict || stored.userType() == value.userType()) && stored == value;
+    }
+
+    /*!
+     * \class QSettingsKeyLess
+     * \brief Transparent key comparison, so keys can be looked up without constructing the key type
+     *
+     * Allows lookups of QString keys by QLatin1String (and QStringView as of Qt 5.12) and of std::string
+     * keys by const char* (and std::string_view as of C++17). Heterogeneous lookup requires C++14,
+     * with C++11 the lookup key is converted into the key type.
+     */
+    struct QSettingsKeyLess
+    {
+        using is_transparent = void;
+
+        template < typename A, typename B >
+        bool operator()(const A& lhs, const B& rhs) const
+        {
+            return lhs < rhs;
+        }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        bool operator()(const QString& lhs, const QStringView rhs) const
+        {
+            return QStringView(lhs).compare(rhs) < 0;
+        }
+
+        bool operator()(const QStringView lhs, const QString& rhs) const
+        {
+            return lhs.compare(QStringView(rhs)) < 0;
+        }
+#endif
+    };
+
+    /*!
+     * \class QSettingsMapStorage
+     * \brief Default QSettingsContainer storage keeping the values in a sorted map
+     *
+     * Works with all supported key types and arbitrary (sparse) keys. Supports heterogeneous lookup,
+     * see QSettingsKeyLess.
+     *
+     * A storage policy provides:
+     * - find(key): a pointer to the stored value or nullptr, the key may be any type comparable to the key type
+     * - contains(key): true if a value is stored for the key
+     * - set(key, value, dirty): stores a value and sets its dirty flag if the value changed, returns true if
+     *   the value changed and false if it is equal to the stored one or the key is not supported by the storage.
+     *   Optionally overloaded for QVariant&& to move the value into place.
+     * - isDirty(key) / isDirty(): true if the value of the key (any value) changed since the last clearDirty()
+     * - forEach(fn) / forEachDirty(fn): calls fn(key, value) for each stored (dirty) value in ascending key order
+     * - clearDirty(), size() and clear()
+     * - reserve(count): prepares for count keys, only required if QSettingsContainer::reserve() is used
+     *
+     * \tparam T_Key The key type
+     */
+    template < typename T_Key >
+    class QSettingsMapStorage
+    {
+    public:
+        using KeyType = T_Key;
+
+        template < typename K >
+        const QVariant* find(const K& key) const
+        {
+            const auto it = m_data.find(key);
+            return it != m_data.end() ? &it->second.value : nullptr;
+        }
+
+        template < typename K >
+        bool contains(const K& key) const
+        {
+            return m_data.find(key) != m_data.end();
+        }
+
+        bool set(const T_Key& key, const QVariant& value, const bool dirty)
+        {
+            return put(key, value, dirty);
+        }
+
+        bool set(const T_Key& key, QVariant&& value, const bool dirty)
+        {
+            return put(key, std::move(value), dirty);
+        }
+
+        template < typename K >
+        bool isDirty(const K& key) const
+        {
+            const auto it = m_data.find(key);
+            return it != m_data.end() && it->second.dirty;
+        }
+
+        bool isDirty() const Q_DECL_NOEXCEPT
+        {
+            return m_dirtyCount > 0;
+        }
+
+        void clearDirty()
+        {
+            if(m_dirtyCount == 0)
+            {
+                return;
+            }
+            for(auto& item : m_data)
+            {
+                item.second.dirty = false;
+            }
+            m_dirtyCount = 0;
+        }
+
+        template < typename Fn >
+        void forEach(Fn&& fn) const
+        {
+            for(const auto& item : m_data)
+            {
+                fn(item.first, item.second.value);
+            }
+        }
+
+        template < typename Fn >
+        void forEachDirty(Fn&& fn) const
+        {
+            if(m_dirtyCount == 0)
+            {
+                return;
+            }
+            for(const auto& item : m_data)
+            {
+                if(item.second.dirty)
+                {
+                    fn(item.first, item.second.value);
+                }
+            }
+        }
+
+        int size() const
+        {
+            return static_cast<int>(m_data.size());
+        }
+
+        void clear()
+        {
+            m_data.clear();
+            m_dirtyCount = 0;
+        }
+
+        //! Nodes are allocated one by one, so there is nothing to reserve
+        void reserve(const int count) Q_DECL_NOEXCEPT
+        {
+            Q_UNUSED(count);
+        }
+
+    private:
+        struct Entry
+        {
+            QVariant    value;
+            bool        dirty;  //<! True if the value changed since the last clearDirty()
+        };
+
+        std::map<T_Key, Entry, QSettingsKeyLess>    m_data;
+        int                                         m_dirtyCount = 0;   //<! The amount of dirty entries
+
+        template < typename V >
+        bool put(const T_Key& key, V&& value, const bool dirty)
+        {
+            // Keys are usually stored in ascending order (e.g. enum loops), appending needs no search
+            auto it = !m_data.empty() && m_data.key_comp()(std::prev(m_data.end())->first, key) ? m_data.end()
+                                                                                                : m_data.lower_bound(key);
+            if(it == m_data.end() || m_data.key_comp()(key, it->first))
+            {
+                m_data.emplace_hint(it, key, Entry{std::forward<V>(value), dirty});
+                m_dirtyCount += dirty ? 1 : 0;
+                return true;
+            }
+
+            auto& entry         = it->second;
+            const auto changed  = !isSameSettingsValue(entry.value, value, dirty);
+            const auto newDirty = changed ? dirty : entry.dirty && dirty;
+            m_dirtyCount       += static_cast<int>(newDirty) - static_cast<int>(entry.dirty);
+            entry.dirty         = newDirty;
+            if(changed)
+            {
+                entry.value = std::forward<V>(value);
+            }
+            return changed;
+        }
+    };
+
+    /*!
+     * \class QSettingsDenseStorage
+     * \brief QSettingsContainer storage for contiguous integral (enum) keys starting at 0
+     *
+     * The values are kept in a contiguous array indexed by the key along with a presence bitset,
+     * so all operations are O(1) array accesses. The array grows on demand up to the highest key
+     * ever stored, so the keys should be dense, e.g. enum values from 0 to DataCount.
+     */
+    class QSettingsDenseStorage
+    {
+    public:
+        using KeyType = int;
+
+        bool contains(const int key) const Q_DECL_NOEXCEPT
+        {
+            return key >= 0 && key < static_cast<int>(m_present.size()) && m_present[key];
+        }
+
+        const QVariant* find(const int key) const Q_DECL_NOEXCEPT
+        {
+            return contains(key) ? &m_values[key] : nullptr;
+        }
+
+        bool set(const int key, const QVariant& value, const bool dirty)
+        {
+            return put(key, value, dirty);
+        }
+
+        bool set(const int key, QVariant&& value, const bool dirty)
+        {
+            return put(key, std::move(value), dirty);
+        }
+
+        bool isDirty(const int key) const Q_DECL_NOEXCEPT
+        {
+            return key >= 0 && key < static_cast<int>(m_dirty.size()) && m_dirty[key];
+        }
+
+        bool isDirty() const Q_DECL_NOEXCEPT
+        {
+            return m_dirtyCount > 0;
+        }
+
+        void clearDirty()
+        {
+            std::fill(m_dirty.begin(), m_dirty.end(), false);
+            m_dirtyCount = 0;
+        }
+
+        template < typename Fn >
+        void forEach(Fn&& fn) const
+        {
+            const auto count = static_cast<int>(m_values.size());
+            for(auto key = 0; key < count; ++key)
+            {
+                if(m_present[key])
+                {
+                    fn(key, m_values[key]);
+                }
+            }
+        }
+
+        template < typename Fn >
+        void forEachDirty(Fn&& fn) const
+        {
+            const auto count = m_dirtyCount > 0 ? static_cast<int>(m_values.size()) : 0;
+            for(auto key = 0; key < count; ++key)
+            {
+                if(m_dirty[key])
+                {
+                    fn(key, m_values[key]);
+                }
+            }
+        }
+
+        int size() const
+        {
+            return static_cast<int>(std::count(m_present.begin(), m_present.end(), true));
+        }
+
+        void clear()
+        {
+            m_values.clear();
+            m_present.clear();
+            m_dirty.clear();
+            m_dirtyCount = 0;
+        }
+
+        //! Allocates the arrays for the keys [0, count) at once
+        void reserve(const int count)
+        {
+            m_values.reserve(count);
+            m_present.reserve(count);
+            m_dirty.reserve(count);
+        }
+
+    private:
+        std::vector<QVariant>   m_values;           //<! The values indexed by their key
+        std::vector<bool>       m_present;          //<! True for each key a value is stored for
+        std::vector<bool>       m_dirty;            //<! True for each key whose value changed since the last clearDirty()
+        int                     m_dirtyCount = 0;   //<! The amount of dirty keys
+
+        template < typename V >
+        bool put(const int key, V&& value, const bool dirty)
+        {
+            if(key < 0)
+            {
+                return false;
+            }
+            if(key >= static_cast<int>(m_values.size()))
+            {
+                m_values.resize(key + 1);
+                m_present.resize(key + 1, false);
+                m_dirty.resize(key + 1, false);
+            }
+
+            const auto changed  = !m_present[key] || !isSameSettingsValue(m_values[key], value, dirty);
+            const auto newDirty = changed ? dirty : m_dirty[key] && dirty;
+            m_dirtyCount       += static_cast<int>(newDirty) - static_cast<int>(m_dirty[key]);
+            m_dirty[key]        = newDirty;
+            m_present[key]      = true;
+            if(changed)
+            {
+                m_values[key] = std::forward<V>(value);
+            }
+            return changed;
+        }
+    };
+
+    /*!
+     * \class QSettingsArrayStorage
+     * \brief QSettingsContainer storage for a compile-time known amount of integral (enum) keys
+     *
+     * Like QSettingsDenseStorage but with a fixed-size array, so no allocation happens at all.
+     * Keys outside of [0, Count) are rejected.
+     *
+     * \tparam Count The amount of keys, e.g. the DataCount value of the key enum
+     */
+    template < std::size_t Count >
+    class QSettingsArrayStorage
+    {
+    public:
+        using KeyType = int;
+
+        bool contains(const int key) const Q_DECL_NOEXCEPT
+        {
+            return key >= 0 && key < static_cast<int>(Count) && m_present[key];
+        }
+
+        const QVariant* find(const int key) const Q_DECL_NOEXCEPT
+        {
+            return contains(key) ? &m_values[key] : nullptr;
+        }
+
+        bool set(const int key, const QVariant& value, const bool dirty)
+        {
+            return put(key, value, dirty);
+        }
+
+        bool set(const int key, QVariant&& value, const bool dirty)
+        {
+            return put(key, std::move(value), dirty);
+        }
+
+        bool isDirty(const int key) const Q_DECL_NOEXCEPT
+        {
+            return key >= 0 && key < static_cast<int>(Count) && m_dirty[key];
+        }
+
+        bool isDirty() const Q_DECL_NOEXCEPT
+        {
+            return m_dirty.any();
+        }
+
+        void clearDirty()
+        {
+            m_dirty.reset();
+        }
+
+        template < typename Fn >
+        void forEach(Fn&& fn) const
+        {
+            for(auto key = 0; key < static_cast<int>(Count); ++key)
+            {
+                if(m_present[key])
+                {
+                    fn(key, m_values[key]);
+                }
+            }
+        }
+
+        template < typename Fn >
+        void forEachDirty(Fn&& fn) const
+        {
+            for(auto key = 0; m_dirty.any() && key < static_cast<int>(Count); ++key)
+            {
+                if(m_dirty[key])
+                {
+                    fn(key, m_values[key]);
+                }
+            }
+        }
+
+        int size() const
+        {
+            return static_cast<int>(m_present.count());
+        }
+
+        void clear()
+        {
+            m_values.fill(QVariant());
+            m_present.reset();
+            m_dirty.reset();
+        }
+
+        //! The array is fixed-size, so there is nothing to reserve
+        void reserve(const int count) Q_DECL_NOEXCEPT
+        {
+            Q_UNUSED(count);
+        }
+
+    private:
+        std::array<QVariant, Count> m_values;   //<! The values indexed by their key
+        std::bitset<Count>          m_present;  //<! Set for each key a value is stored for
+        std::bitset<Count>          m_dirty;    //<! Set for each key whose value changed since the last clearDirty()
+
+        template < typename V >
+        bool put(const int key, V&& value, const bool dirty)
+        {
+            if(key < 0 || key >= static_cast<int>(Count))
+            {
+                return false;
+            }
+
+            const auto changed = !m_present[key] || !isSameSettingsValue(m_values[key], value, dirty);
+            m_dirty.set(key, changed ? dirty : m_dirty[key] && dirty);
+            m_present.set(key);
+            if(changed)
+            {
+                m_values[key] = std::forward<V>(value);
+            }
+            return changed;
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QSETTINGSSTORAGE_H
@@ -0,0 +1,221 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QSETTINGSTRANSACTION_H
+#define QSETTINGSTRANSACTION_H
+
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSettings>
+#include <QtCore/QStringBuilder>
+#include <functional>
+#include <vector>
+
+#include "QSettingsContainer.h"
+
+namespace qtex
+{
+    /*!
+     * \class QSettingsTransaction
+     * \brief Collects the changes of several settings containers and writes them all or nothing
+     *
+     * Saving e.g. a workspace usually writes a dozen containers one after another. A crash in between leaves
+     * the settings half-updated. A transaction instead collects the dirty values of all containers into one
+     * change set, which commit() writes in a single pass followed by a single sync().
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * QSettings settings("workspace.ini", QSettings::IniFormat);
+     * QSettingsTransaction transaction(settings);
+     *
+     * transaction.begin();
+     * transaction.add(view);
+     * transaction.add(recent);
+     * if(!transaction.commit())
+     * {
+     *     transaction.rollback();
+     * }
+     * \endcode
+     *
+     * For INI files (including the native format on Unix systems other than macOS) the change set is applied
+     * to a copy of the file, which then atomically replaces the original via QSaveFile. So the file contains
+     * either all or none of the changes. Other backends, e.g. the Windows registry, are written directly and
+     * synced once, which is faster than syncing per container but not atomic.
+     *
+     * The containers stay dirty until commit() succeeded, so after a failed commit or a rollback() they can
+     * still be written in some other way. Don't modify added containers before committing, since a successful
+     * commit clears all of their dirty flags.
+     */
+    class QSettingsTransaction
+    {
+    public:
+        /*!
+         * Constructs an inactive transaction
+         * \param settings The settings to commit to, must not be within a group as the changes are group qualified
+         */
+        explicit QSettingsTransaction(QSettings& settings)
+            : m_settings    (settings)
+        {
+        }
+
+        QSettingsTransaction(const QSettingsTransaction&) = delete;
+        QSettingsTransaction& operator=(const QSettingsTransaction&) = delete;
+
+        //! Starts collecting changes, discards the change set of a previous uncommitted transaction
+        void begin()
+        {
+            rollback();
+            m_active = true;
+        }
+
+        //! True between begin() and commit() or rollback()
+        bool isActive() const Q_DECL_NOEXCEPT
+        {
+            return m_active;
+        }
+
+        /*!
+         * Adds the dirty values of a container to the change set
+         * \param container The container, e.g. a QSettingsContainer, QObservableSettingsContainer,
+         * QConcurrentSettingsContainer or QTypedSettingsContainer. Must outlive the transaction.
+         * \remark The dirty flags are only cleared by a successful commit()
+         */
+        template < typename Container >
+        void add(Container& container)
+        {
+            Q_ASSERT(m_active);
+            add(container.getChanges());
+            m_clear.push_back([&container]() { container.clearDirty(); });
+        }
+
+        /*!
+         * Adds changes to the change set, e.g. retrieved by QSettingsContainer::getChanges().
+         * Unlike containers added by add(Container&), nothing is marked as written on commit()
+         * \param changes The group qualified values, a later change of a key wins over an earlier one
+         */
+        void add(const QSettingsChanges& changes)
+        {
+            Q_ASSERT(m_active);
+            for(const auto& change : changes)
+            {
+                m_changes.insert(change.first, change.second);
+            }
+        }
+
+        /*!
+         * Writes the change set and clears the dirty flags of the added containers
+         * \returns False if writing failed, the transaction then stays active with its change set
+         */
+        bool commit()
+        {
+            Q_ASSERT(m_active);
+            Q_ASSERT(m_settings.group().isEmpty());
+
+            if(!m_changes.isEmpty() && !(isFileBased() ? replaceFile() : writeDirect()))
+            {
+                return false;
+            }
+
+            for(const auto& clear : m_clear)
+            {
+                clear();
+            }
+            m_changes.clear();
+            m_clear.clear();
+            m_active = false;
+            return true;
+        }
+
+        //! Discards the change set, the added containers stay dirty
+        void rollback()
+        {
+            m_changes.clear();
+            m_clear.clear();
+            m_active = false;
+        }
+
+        //! The amount of changed keys
+        int size() const
+        {
+            return m_changes.size();
+        }
+
+    private:
+        QSettings&                          m_settings;
+        QMap<QString, QVariant>             m_changes;          //<! The change set by group qualified key
+        std::vector<std::function<void()>>  m_clear;            //<! Clear the dirty flags of the added containers
+        bool                                m_active = false;   //<! True between begin() and commit() or rollback()
+
+        //! True if the settings are an INI file which can be replaced as a whole
+        bool isFileBased() const
+        {
+#if defined(Q_OS_UNIX) && !defined(Q_OS_DARWIN)
+            const auto ini = m_settings.format() == QSettings::IniFormat || m_settings.format() == QSettings::NativeFormat;
+#else
+            const auto ini = m_settings.format() == QSettings::IniFormat;
+#endif
+            return ini && !m_settings.fileName().isEmpty();
+        }
+
+        //! Writes the change set into the settings and syncs once
+        bool writeDirect()
+        {
+            for(auto it = m_changes.cbegin(); it != m_changes.cend(); ++it)
+            {
+                m_settings.setValue(it.key(), it.value());
+            }
+            m_settings.sync();
+            return m_settings.status() == QSettings::NoError;
+        }
+
+        //! Writes the change set into a copy of the INI file, which then atomically replaces the file
+        bool replaceFile()
+        {
+            // Flush the pending changes of the settings first, so the copy contains them
+            m_settings.sync();
+
+            const auto    path    = m_settings.fileName();
+            const QString staging = path % QLatin1String(".transaction");
+            QFile::remove(staging);
+            if(QFile::exists(path) && !QFile::copy(path, staging))
+            {
+                return false;
+            }
+
+            auto staged = false;
+            {
+                QSettings copy(staging, QSettings::IniFormat);
+                for(auto it = m_changes.cbegin(); it != m_changes.cend(); ++it)
+                {
+                    copy.setValue(it.key(), it.value());
+                }
+                copy.sync();
+                staged = copy.status() == QSettings::NoError;
+            }
+
+            QFile     source(staging);
+            QSaveFile target(path);
+            staged = staged && source.open(QIODevice::ReadOnly) && target.open(QIODevice::WriteOnly);
+            if(staged)
+            {
+                const auto content = source.readAll();
+                staged = target.write(content) == content.size() && target.commit();
+            }
+            source.close();
+            QFile::remove(staging);
+
+            // Picks up the replaced file
+            m_settings.sync();
+            return staged;
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QSETTINGSTRANSACTION_H
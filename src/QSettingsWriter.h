@@ -0,0 +1,296 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+#ifndef QSETTINGSWRITER_H
+#define QSETTINGSWRITER_H
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QFuture>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QMap>
+#include <QtCore/QObject>
+#include <QtCore/QSettings>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "QSettingsContainer.h"
+
+namespace qtex
+{
+    /*!
+     * \class QSettingsWriter
+     * \brief Persists settings changes asynchronously on a dedicated worker thread
+     *
+     * Instead of writing a QSettingsContainer from a UI slot, which blocks the GUI thread on registry or
+     * INI file I/O, its pending changes are handed over to the writer. The writer collects them for a
+     * debounce interval, so a burst of changes (e.g. dragging a slider) results in a single write. Then an
+     * immutable snapshot of the collected changes is written and synced on the worker thread, using a
+     * QSettings instance that is owned and only ever used by that thread.
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * QSettingsWriter writer(QSettings::IniFormat, "settings.ini");
+     *
+     * proceduralData.setValue(DataA, checkbox->value());
+     * writer.schedule(proceduralData);
+     * ...
+     * writer.flush(); // e.g. at shutdown
+     * \endcode
+     *
+     * The writer must be used from the thread it lives in, which needs a running event loop.
+     * The changes are written in the order they have been scheduled, a later change of a key
+     * wins over an earlier one that has not been written yet.
+     *
+     * If a write fails (e.g. a read-only file or a full disk) writeFailed() is emitted and the changes
+     * are pending again, so they are written along with the next schedule() or flush().
+     */
+    class QSettingsWriter : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        //! Creates the QSettings instance used by the worker thread
+        using Factory = std::function<QSettings*()>;
+
+        /*!
+         * Constructs a writer for the default application settings (see QSettings::QSettings(QObject*))
+         * \param debounce The debounce interval in milliseconds
+         * \param parent The parent QObject
+         */
+        explicit QSettingsWriter(const int debounce = 500, QObject* parent = nullptr)
+            : QSettingsWriter([]() { return new QSettings(); }, debounce, parent)
+        {
+        }
+
+        /*!
+         * Constructs a writer for a settings file
+         * \param format The settings format, e.g. QSettings::IniFormat
+         * \param fileName The path of the settings file
+         * \param debounce The debounce interval in milliseconds
+         * \param parent The parent QObject
+         */
+        QSettingsWriter(const QSettings::Format format, const QString& fileName, const int debounce = 500,
+                        QObject* parent = nullptr)
+            : QSettingsWriter([format, fileName]() { return new QSettings(fileName, format); }, debounce, parent)
+        {
+        }
+
+        /*!
+         * Constructs a writer
+         * \param factory Creates the QSettings instance, called once on the worker thread
+         * \param debounce The debounce interval in milliseconds
+         * \param parent The parent QObject
+         */
+        QSettingsWriter(Factory factory, const int debounce, QObject* parent = nullptr)
+            : QObject   (parent)
+            , m_worker  (std::make_shared<Worker>(std::move(factory)))
+            , m_timer   (new QTimer(this))
+        {
+            m_pool.setMaxThreadCount(1);
+            m_pool.setExpiryTimeout(-1);
+
+            m_timer->setSingleShot(true);
+            m_timer->setInterval(debounce);
+            connect(m_timer, &QTimer::timeout, this, &QSettingsWriter::dispatch);
+        }
+
+        //! Writes all pending changes before destruction
+        ~QSettingsWriter()
+        {
+            flush();
+        }
+
+        /*!
+         * Schedules the dirty values of a container to be written and clears its dirty flags
+         * \param container The settings container, see QSettingsContainer::takeChanges()
+         */
+        template < typename Container >
+        void schedule(Container& container)
+        {
+            schedule(container.takeChanges());
+        }
+
+        /*!
+         * Schedules changes to be written, restarts the debounce interval
+         * \param changes The values as group qualified QSettings keys
+         */
+        void schedule(const QSettingsChanges& changes)
+        {
+            if(changes.isEmpty())
+            {
+                return;
+            }
+
+            for(const auto& change : changes)
+            {
+                m_pending.insert(change.first, change.second);
+            }
+            m_timer->start();
+        }
+
+        /*!
+         * Writes all pending changes and blocks until they have been written and synced
+         * \returns False if a write failed, see getStatus()
+         */
+        bool flush()
+        {
+            m_timer->stop();
+            dispatch();
+            m_last.waitForFinished();
+            collect();
+            return m_status == QSettings::NoError;
+        }
+
+        //! True if changes are pending or being written
+        bool isPending() const
+        {
+            return !m_pending.isEmpty() || !m_last.isFinished();
+        }
+
+        //! The status of the most recently completed write
+        QSettings::Status getStatus() const Q_DECL_NOEXCEPT
+        {
+            return m_status;
+        }
+
+        //! Sets the debounce interval in milliseconds
+        void setDebounceInterval(const int debounce)
+        {
+            m_timer->setInterval(debounce);
+        }
+
+        //! Retrieves the debounce interval in milliseconds
+        int getDebounceInterval() const
+        {
+            return m_timer->interval();
+        }
+
+    signals:
+        //! Emitted if writing or syncing changes failed, the changes are pending again
+        void writeFailed(QSettings::Status status);
+
+    private:
+        //! The worker thread state, only accessed by the single worker thread
+        struct Worker
+        {
+            explicit Worker(Factory f) : factory(std::move(f))
+            {
+            }
+
+            Factory                     factory;
+            std::unique_ptr<QSettings>  settings;   //<! Created on first use by the worker thread
+        };
+
+        using Snapshot = std::shared_ptr<const QMap<QString, QVariant>>;
+
+        //! A dispatched write whose result has not been collected yet
+        struct Write
+        {
+            QFuture<QSettings::Status>  future;
+            Snapshot                    changes;
+        };
+
+        QThreadPool                 m_pool;     //<! Runs the single worker thread
+        std::shared_ptr<Worker>     m_worker;
+        QTimer*                     m_timer;    //<! The debounce timer
+        QMap<QString, QVariant>     m_pending;  //<! The coalesced changes not yet dispatched
+        QFuture<QSettings::Status>  m_last;     //<! The most recently dispatched write
+        std::vector<Write>          m_writes;   //<! The dispatched writes in order, until collected
+        QSettings::Status           m_status = QSettings::NoError; //<! The status of the last collected write
+
+        //! Hands the pending changes over to the worker thread
+        void dispatch()
+        {
+            if(m_pending.isEmpty())
+            {
+                return;
+            }
+
+            const auto worker   = m_worker;
+            const auto snapshot = std::make_shared<const QMap<QString, QVariant>>(std::move(m_pending));
+            m_pending           = QMap<QString, QVariant>();
+
+            // The pool runs a single thread, so the writes are executed in the order they are dispatched
+            m_last = QtConcurrent::run(&m_pool, [worker, snapshot]()
+            {
+                return persist(*worker, *snapshot);
+            });
+            m_writes.push_back(Write{m_last, snapshot});
+
+            auto* watcher = new QFutureWatcher<QSettings::Status>(this);
+            connect(watcher, &QFutureWatcher<QSettings::Status>::finished, this, [this, watcher]()
+            {
+                collect();
+                watcher->deleteLater();
+            });
+            watcher->setFuture(m_last);
+        }
+
+        /*!
+         * Collects the results of the finished writes in dispatch order, puts the changes of failed
+         * ones back into the pending changes unless superseded by a later change of the same key
+         */
+        void collect()
+        {
+            auto failed = QSettings::NoError;
+            auto done   = m_writes.begin();
+            for(; done != m_writes.end() && done->future.isFinished(); ++done)
+            {
+                m_status = done->future.result();
+                if(m_status == QSettings::NoError)
+                {
+                    continue;
+                }
+                failed = m_status;
+
+                const auto& changes = *done->changes;
+                for(auto it = changes.cbegin(); it != changes.cend(); ++it)
+                {
+                    const auto superseded = std::any_of(done + 1, m_writes.end(), [&it](const Write& write)
+                    {
+                        return write.changes->contains(it.key());
+                    });
+                    if(!superseded && !m_pending.contains(it.key()))
+                    {
+                        m_pending.insert(it.key(), it.value());
+                    }
+                }
+            }
+            m_writes.erase(m_writes.begin(), done);
+
+            // Only emitted once the writes are collected, as a receiver may schedule or flush right away
+            if(failed != QSettings::NoError)
+            {
+                emit writeFailed(failed);
+            }
+        }
+
+        //! Writes and syncs a snapshot, runs on the worker thread
+        static QSettings::Status persist(Worker& worker, const QMap<QString, QVariant>& changes)
+        {
+            if(!worker.settings)
+            {
+                worker.settings.reset(worker.factory());
+            }
+
+            for(auto it = changes.cbegin(); it != changes.cend(); ++it)
+            {
+                worker.settings->setValue(it.key(), it.value());
+            }
+            worker.settings->sync();
+            return worker.settings->status();
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QSETTINGSWRITER_H
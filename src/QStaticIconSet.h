@@ -0,0 +1,170 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ * Requires C++14
+ */
+
+#ifndef QSTATICICONSET_H
+#define QSTATICICONSET_H
+
+#include <QtGui/QIcon>
+#include <array>
+#include <type_traits>
+#include <utility>
+
+#include "QIconSetEngine.h"
+
+namespace qtex
+{
+    /*!
+     * \class QIconGridLayout
+     * \brief Compile-time description of a uniform icon set grid for QStaticIconSet
+     *
+     * \tparam T_Id The enum type identifying the icons, its values are the 1D indices into the grid
+     * \tparam Columns The amount of icon columns
+     * \tparam Rows The amount of icon rows
+     * \tparam IconWidth The width of each icon in pixels
+     * \tparam IconHeight The height of each icon in pixels
+     */
+    template < typename T_Id, int Columns, int Rows, int IconWidth, int IconHeight >
+    struct QIconGridLayout
+    {
+        static_assert(std::is_enum<T_Id>::value, "T_Id must be of enum type");
+
+        using Id = T_Id;
+
+        static constexpr int count          = Columns * Rows;        //<! The amount of icons
+        static constexpr int sheetWidth     = Columns * IconWidth;   //<! The width of the icon set image
+        static constexpr int sheetHeight    = Rows * IconHeight;     //<! The height of the icon set image
+
+        //! Converts a 2D index position (column/row) into a 1D index, e.g. to define the enum values
+        static constexpr int index(const int col, const int row)
+        {
+            return row * Columns + col;
+        }
+
+        //! The area an icon occupies within the icon set image
+        static constexpr QRect rect(const int index)
+        {
+            return QRect((index % Columns) * IconWidth, (index / Columns) * IconHeight, IconWidth, IconHeight);
+        }
+    };
+
+    /*!
+     * \class QStaticIconSet
+     * \brief Icon set whose layout is fully known at compile time
+     *
+     * In contrast to QIconSet the layout (the icon areas per enum value) is given by a constexpr description,
+     * so all source areas are computed at compile time and an icon lookup is a single array access without
+     * any runtime checks. Layout mistakes, like areas outside of the icon set image or ids outside of the
+     * layout, fail the build instead of showing up as invalid icons at runtime.
+     *
+     * A layout provides the enum type \c Id, the amount of icons \c count, the size of the icon set image
+     * \c sheetWidth / \c sheetHeight and a constexpr \c rect(int) retrieving the area of each icon.
+     * QIconGridLayout describes a uniform grid, custom layouts may provide arbitrary areas per enum value.
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * enum class ButtonIcon { Play, Pause, Stop };
+     * using ButtonLayout = QIconGridLayout<ButtonIcon, 3, 1, 32, 32>;
+     *
+     * const QStaticIconSet<ButtonLayout> icons(":/buttons/iconset.png");
+     * button->setIcon(icons.getIcon<ButtonIcon::Pause>());
+     * \endcode
+     *
+     * All icons paint straight from the shared icon set image (see QIconSetEngine).
+     *
+     * \tparam Layout The compile-time layout description
+     */
+    template < typename Layout >
+    class QStaticIconSet
+    {
+    public:
+        using Id = typename Layout::Id;
+
+        static constexpr int Count = Layout::count;   //<! The amount of icons
+
+        /*!
+         * Constructs the icon set out of a resource image file path
+         * \param path The resource path of the icon set, e.g. ":/buttons/iconset.png"
+         */
+        explicit QStaticIconSet(const QString& path)
+            : m_iconset (path)
+        {
+            static_assert(std::is_enum<Id>::value, "Layout::Id must be of enum type");
+            static_assert(Count > 0, "The layout must contain at least one icon");
+            static_assert(isValidLayout(), "The layout contains empty areas or areas outside of the icon set image");
+
+            Q_ASSERT(m_iconset.width() >= Layout::sheetWidth && m_iconset.height() >= Layout::sheetHeight);
+
+            constexpr auto rects = makeRects(std::make_index_sequence<Count>());
+            for(auto index = 0; index < Count; ++index)
+            {
+                m_icons[index] = QIcon(new QIconSetEngine(m_iconset, rects[index]));
+            }
+        }
+
+        /*!
+         * Get an icon, the id is checked against the layout at compile time
+         * \tparam id The id of the icon
+         * \returns The icon as a QIcon
+         */
+        template < Id id >
+        const QIcon& getIcon() const Q_DECL_NOEXCEPT
+        {
+            static_assert(static_cast<int>(id) >= 0 && static_cast<int>(id) < Count, "Icon id is out of the layout's range");
+
+            return m_icons[static_cast<int>(id)];
+        }
+
+        /*!
+         * Get an icon without any checks
+         * \param id The id of the icon, must be within the layout
+         * \returns The icon as a QIcon
+         */
+        const QIcon& getIcon(const Id id) const Q_DECL_NOEXCEPT
+        {
+            return m_icons[static_cast<int>(id)];
+        }
+
+        /*!
+         * Retrieves the area an icon occupies within the icon set image, computed at compile time
+         * \param id The id of the icon
+         * \returns The icon area in pixels
+         */
+        static constexpr QRect getIconRect(const Id id)
+        {
+            return Layout::rect(static_cast<int>(id));
+        }
+
+    private:
+        QPixmap                     m_iconset;  //<! The icon set image
+        std::array<QIcon, Count>    m_icons;    //<! All icons, indexed by their id
+
+        template < std::size_t... I >
+        static constexpr std::array<QRect, sizeof...(I)> makeRects(std::index_sequence<I...>)
+        {
+            return {{Layout::rect(static_cast<int>(I))...}};
+        }
+
+        static constexpr bool isValidLayout()
+        {
+            for(auto index = 0; index < Count; ++index)
+            {
+                const auto rect = Layout::rect(index);
+                if(rect.x() < 0 || rect.y() < 0 || rect.width() <= 0 || rect.height() <= 0 ||
+                   rect.right() >= Layout::sheetWidth || rect.bottom() >= Layout::sheetHeight)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QSTATICICONSET_H
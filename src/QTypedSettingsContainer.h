@@ -0,0 +1,235 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ * Requires C++14
+ */
+
+#ifndef QTYPEDSETTINGSCONTAINER_H
+#define QTYPEDSETTINGSCONTAINER_H
+
+#include <QtCore/QSettings>
+#include <QtCore/QString>
+#include <QtCore/QStringBuilder>
+#include <QtCore/QVariant>
+#include <bitset>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "QSettingsContainer.h"
+
+namespace qtex
+{
+    /*!
+     * \class QTypedSettingsContainer
+     * \brief Settings container with a compile-time schema storing its values unboxed
+     *
+     * Where QSettingsContainer keeps QVariants and converts on every value() call, the schema of this
+     * container declares the C++ type of each key, so the values are stored as plain members of a tuple.
+     * Retrieving a value is a reference to that member without any conversion, copy or lookup.
+     * QVariant is only used at the QSettings boundary, i.e. in read() and write().
+     *
+     * The keys are the values of an enum from 0 to the amount of types in the schema. The QSettings keys
+     * are the same as the ones of an EnumQSettingsContainer, so the two can be used for the same group.
+     *
+     * Example how to use it.
+     * \code {.cpp}
+     * enum class ViewSettings { Zoom, GridSpacing, ShowGrid, Theme };
+     * using ViewSchema = std::tuple<double, int, bool, QString>;
+     *
+     * QTypedSettingsContainer<ViewSettings, ViewSchema> view("View", ViewSchema{1.0, 8, true, "dark"});
+     * view.read(settings);
+     * const auto zoom = view.value<ViewSettings::Zoom>();
+     * view.setValue<ViewSettings::GridSpacing>(16);
+     * view.write(settings);
+     * \endcode
+     *
+     * Like QSettingsContainer only changed (dirty) values are written by write().
+     *
+     * \tparam T_Key The enum type of the keys
+     * \tparam T_Schema A std::tuple of the value types, indexed by the key values
+     */
+    template < typename T_Key, typename T_Schema >
+    class QTypedSettingsContainer;
+
+    template < typename T_Key, typename... T_Types >
+    class QTypedSettingsContainer<T_Key, std::tuple<T_Types...>>
+    {
+        static_assert(std::is_enum<T_Key>::value, "Key type must be an enumeration type.");
+
+    public:
+        using Schema = std::tuple<T_Types...>;
+
+        static constexpr std::size_t Count = sizeof...(T_Types);   //<! The amount of keys
+
+        //! The value type of a key
+        template < T_Key key >
+        using ValueType = typename std::tuple_element<static_cast<std::size_t>(key), Schema>::type;
+
+        /*!
+         * Constructs the container
+         * \param group The settings group name
+         * \param defaults The default values used until read() provides others
+         */
+        explicit QTypedSettingsContainer(const QString& group, Schema defaults = Schema())
+            : m_group   (group)
+            , m_values  (std::move(defaults))
+        {
+        }
+
+        //! reads the schema's settings of the given settings group, missing or inconvertible ones are left untouched
+        void read(QSettings& settings)
+        {
+            settings.beginGroup(m_group);
+            readValues(settings, std::index_sequence_for<T_Types...>());
+            settings.endGroup();
+        }
+
+        //! writes the dirty settings to the given settings group and clears the dirty flags
+        void write(QSettings& settings)
+        {
+            if(m_dirty.none())
+            {
+                return;
+            }
+
+            settings.beginGroup(m_group);
+            writeValues(settings, true, std::index_sequence_for<T_Types...>());
+            settings.endGroup();
+            m_dirty.reset();
+        }
+
+        //! writes all settings to the given settings group, the dirty flags are left untouched
+        void writeAll(QSettings& settings) const
+        {
+            settings.beginGroup(m_group);
+            writeValues(settings, false, std::index_sequence_for<T_Types...>());
+            settings.endGroup();
+        }
+
+        /*!
+         * Takes the dirty values and clears the dirty flags, e.g. to persist them with a QSettingsWriter
+         * \returns The dirty values as group qualified QSettings keys
+         */
+        QSettingsChanges takeChanges()
+        {
+            auto changes = getChanges();
+            m_dirty.reset();
+            return changes;
+        }
+
+        /*!
+         * Retrieves the dirty values, the dirty flags are left untouched (see QSettingsTransaction)
+         * \returns The dirty values as group qualified QSettings keys
+         */
+        QSettingsChanges getChanges() const
+        {
+            QSettingsChanges changes;
+            const auto prefix = m_group.isEmpty() ? QString() : QString(m_group % QLatin1Char('/'));
+            collectValues(changes, prefix, std::index_sequence_for<T_Types...>());
+            return changes;
+        }
+
+        //! Retrieves a value, without any conversion
+        template < T_Key key >
+        const ValueType<key>& value() const Q_DECL_NOEXCEPT
+        {
+            return std::get<index<key>()>(m_values);
+        }
+
+        //! Sets a value, returns true if the value changed
+        template < T_Key key >
+        bool setValue(const ValueType<key>& value)
+        {
+            auto& stored = std::get<index<key>()>(m_values);
+            if(stored == value)
+            {
+                return false;
+            }
+
+            stored = value;
+            m_dirty.set(index<key>());
+            return true;
+        }
+
+        //! returns true if the value changed since the last write
+        template < T_Key key >
+        bool isDirty() const
+        {
+            return m_dirty[index<key>()];
+        }
+
+        //! returns true if any value changed since the last write
+        bool isDirty() const
+        {
+            return m_dirty.any();
+        }
+
+        //! marks all values as written, e.g. after they have been persisted in some other way
+        void clearDirty()
+        {
+            m_dirty.reset();
+        }
+
+        inline const QString& getGroupName() const
+        {
+            return m_group;
+        }
+
+    private:
+        QString             m_group;
+        Schema              m_values;   //<! The unboxed values indexed by their key
+        std::bitset<Count>  m_dirty;    //<! Set for each key whose value changed since the last write
+
+        template < T_Key key >
+        static constexpr std::size_t index()
+        {
+            static_assert(static_cast<std::size_t>(key) < Count, "Key is out of the schema's range.");
+            return static_cast<std::size_t>(key);
+        }
+
+        template < std::size_t... I >
+        void readValues(QSettings& settings, std::index_sequence<I...>)
+        {
+            using expand = int[];
+            (void)expand{0, (readValue<I>(settings), 0)...};
+        }
+
+        template < std::size_t I >
+        void readValue(QSettings& settings)
+        {
+            using T = typename std::tuple_element<I, Schema>::type;
+
+            // canConvert() only checks the types, so e.g. "abc" would be read as an int 0
+            auto variant = settings.value(QString::number(I));
+            if(variant.isValid() && variant.convert(qMetaTypeId<T>()))
+            {
+                std::get<I>(m_values) = variant.template value<T>();
+                m_dirty.reset(I);
+            }
+        }
+
+        template < std::size_t... I >
+        void writeValues(QSettings& settings, const bool dirtyOnly, std::index_sequence<I...>) const
+        {
+            using expand = int[];
+            (void)expand{0, ((!dirtyOnly || m_dirty[I]) ?
+                             (settings.setValue(QString::number(I), QVariant::fromValue(std::get<I>(m_values))), 0) : 0)...};
+        }
+
+        template < std::size_t... I >
+        void collectValues(QSettingsChanges& changes, const QString& prefix, std::index_sequence<I...>) const
+        {
+            using expand = int[];
+            (void)expand{0, (m_dirty[I] ?
+                             (changes.append(qMakePair(QString(prefix % QString::number(I)),
+                                                       QVariant::fromValue(std::get<I>(m_values)))), 0) : 0)...};
+        }
+    };
+}    // namespace qtex
+
+
+#endif    // QTYPEDSETTINGSCONTAINER_H
@@ -0,0 +1,184 @@
+/*
+ * Origin: https://github.com/SamirKharchi/qtex
+ * Author: Samir Kharchi 2017
+ * License: LGPL 3
+ *
+ * Assumes at least Qt 5.6
+ */
+
+/*!
+ * Compile-only smoke test: includes every header and instantiates its templates and QObjects once,
+ * so a broken tool fails the build rather than the first project using it. Nothing is executed.
+ */
+
+#include <QtCore/QSettings>
+#include <QtGui/QPainter>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+template < typename T >
+constexpr typename std::underlying_type<T>::type underlying(const T value) Q_DECL_NOEXCEPT
+{
+    return static_cast<typename std::underlying_type<T>::type>(value);
+}
+
+#include "QConcurrentSettingsContainer.h"
+#include "QIconAtlas.h"
+#include "QIconEffect.h"
+#include "QIconSet.h"
+#include "QIconSetCache.h"
+#include "QIconSetCacheFile.h"
+#include "QIconSetEngine.h"
+#include "QIconSetTexture.h"
+#include "QMetrics.h"
+#include "QObservableSettingsContainer.h"
+#include "QSettingsContainer.h"
+#include "QSettingsRegistry.h"
+#include "QSettingsSnapshot.h"
+#include "QSettingsStorage.h"
+#include "QSettingsTransaction.h"
+#include "QSettingsWriter.h"
+#include "QStaticIconSet.h"
+#include "QTypedSettingsContainer.h"
+
+namespace
+{
+    enum class Id { A, B, Count };
+    enum class Column { A, B };
+    enum class Button { Play, Pause, Stop };
+
+    using ButtonLayout = qtex::QIconGridLayout<Button, 3, 1, 32, 32>;
+    using ViewSchema   = std::tuple<double, int, bool, QString>;
+    enum class View { Zoom, Grid, Show, Theme };
+}
+
+void smokeIconSet(QObject* parent)
+{
+    using qtex::QIconSet;
+
+    QIconSet iconSet(QStringLiteral(":/a.png"), QPoint(2, 2), QPoint(16, 16), nullptr,
+                     QIconSet::LazyExtraction | QIconSet::SkipEmptyTiles | QIconSet::TrimTransparentBorders);
+    iconSet.getIcon(1);
+    iconSet.getIcon(Column::A);
+    iconSet.getIcon(Column::A, Column::B);
+    iconSet.addResolution(QStringLiteral(":/a@2x.png"), 2.0);
+    iconSet.setModeEffect(QIcon::Disabled, qtex::QIconEffect(true, QColor(), 0.5));
+    iconSet.setResidencyTimeout(1000);
+    iconSet.setWatching(true);
+    (void)iconSet.getMemoryUsage();
+    (void)iconSet.getSheetImage();
+    QIconSet moved(std::move(iconSet));
+
+    auto* async  = QIconSet::loadAsync(QStringLiteral(":/a.png"), QPoint(4, 4), QPoint(), parent);
+    auto* cached = QIconSet::loadCached(QStringLiteral("a.cache"), QStringLiteral(":/a.png"), QPoint(4, 4), QPoint(), parent);
+    cached->saveCache(QStringLiteral("a.cache"));
+    (void)async->isLoaded();
+
+    auto shared = qtex::QIconSetCache::instance().acquire(QStringLiteral(":/a.png"), QPoint(8, 4));
+    shared->getIcon(2, 1);
+    qtex::QIconSetCache::instance().setMemoryBudget(1024);
+
+    (void)qtex::QIconSetTexture::getTextureRects(moved);
+#ifndef QT_NO_OPENGL
+    delete qtex::QIconSetTexture::createOpenGLTexture(moved, true);
+#endif
+
+    QPixmap              pixmap;
+    QPainter             painter;
+    qtex::QIconSetEngine engine(pixmap, QRect());
+    engine.paint(&painter, QRect(), QIcon::Disabled, QIcon::Off);
+    (void)engine.pixmap(QSize(16, 16), QIcon::Selected, QIcon::Off);
+}
+
+void smokeIconAtlas()
+{
+    qtex::QIconAtlas atlas(QStringLiteral(":/a.png"), QStringLiteral(":/a.json"));
+    atlas.getIcon(QStringLiteral("open"));
+    atlas.getIcon(0);
+    atlas.saveLayout(QStringLiteral("a.json"));
+
+    const qtex::QStaticIconSet<ButtonLayout> buttons(QStringLiteral(":/buttons.png"));
+    buttons.getIcon<Button::Pause>();
+    buttons.getIcon(Button::Stop);
+}
+
+void smokeSettings(QSettings& settings)
+{
+    const std::vector<float> values(2, 1.f);
+
+    EnumQSettingsContainer enums(QStringLiteral("enum"));
+    enums.setValue(Id::A, QVariant(1));
+    enums.setValues(0, values.begin(), values.end());
+    enums.read(settings);
+    enums.write(settings);
+    enums.readLazy(settings);
+    enums.prefetch(std::vector<Id>{Id::A});
+    (void)enums.value(Id::A, 1.f);
+
+    DenseEnumQSettingsContainer dense(QStringLiteral("dense"));
+    dense.reserve(underlying(Id::Count));
+    dense.setValue(Id::B, QVariant(2));
+    dense.writeAll(settings);
+
+    FixedEnumQSettingsContainer<underlying(Id::Count)> fixed(QStringLiteral("fixed"));
+    fixed.setValue(Id::A, QVariant(true));
+    (void)fixed.takeChanges();
+
+    StringQSettingsContainer strings(QStringLiteral("string"));
+    strings.setValue(QStringLiteral("a"), QVariant(1));
+    (void)strings.value(QLatin1String("a"), 1);
+
+    StdStringQSettingsContainer stdStrings(QStringLiteral("stdstring"));
+    stdStrings.setValue("a", QVariant(1));
+    (void)stdStrings.contains("a");
+
+    const auto stamp = qtex::QSettingsSnapshot::stampOf(settings);
+    if(auto snapshot = qtex::QSettingsSnapshot::open(QStringLiteral("s.bin"), stamp))
+    {
+        enums.readLazy(snapshot);
+    }
+    enums.saveSnapshot(QStringLiteral("s.bin"), stamp);
+
+    qtex::QSettingsRegistry registry;
+    registry.add<EnumQSettingsContainer>(QStringLiteral("View"));
+    registry.read(settings, qtex::QSettingsRegistry::ReadMode::Parallel);
+    registry.write(settings);
+
+    qtex::QSettingsWriter writer(QSettings::IniFormat, QStringLiteral("w.ini"));
+    writer.schedule(enums);
+    writer.flush();
+
+    qtex::QObservableSettingsContainer<int> observable(QStringLiteral("observable"));
+    const auto id = observable.observe(Id::A, [](int, const QVariant&) {});
+    observable.setValue(Id::A, QVariant(3));
+    observable.unobserve(id);
+
+    qtex::QConcurrentSettingsContainer<int> concurrent(QStringLiteral("concurrent"));
+    concurrent.update([](EnumQSettingsContainer& data) { data.setValue(Id::A, QVariant(2)); });
+    (void)concurrent.snapshot()->value(Id::A, false);
+
+    qtex::QTypedSettingsContainer<View, ViewSchema> typed(QStringLiteral("typed"),
+                                                          ViewSchema{1.0, 8, true, QString()});
+    typed.read(settings);
+    typed.setValue<View::Grid>(16);
+    (void)typed.value<View::Zoom>();
+
+    qtex::QSettingsTransaction transaction(settings);
+    transaction.begin();
+    transaction.add(enums);
+    transaction.add(observable);
+    transaction.add(concurrent);
+    transaction.add(typed);
+    if(!transaction.commit())
+    {
+        transaction.rollback();
+    }
+}
+
+int main()
+{
+    return 0;
+}